@@ -0,0 +1,301 @@
+///
+/// File: astar.c
+///
+/// Description: The best-first search engines: A* with a Manhattan distance
+///              heuristic, and Jump Point Search (A* over the jump points of a
+///              4-connected grid). Both use the binary Heap as their priority
+///              queue and give the same (optimal) step counts as the BFS.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#include <stdbool.h> // boolean items
+#include <stdio.h> // error reporting
+#include <stdlib.h> // allocation functions
+#include "solve.h" // the functions we need to write are in here
+#include "heap.h" // the priority queue
+#include "stats.h" // instrumentation counters
+
+
+// the directions a jump point can be reached in (NONE is the start)
+enum { EAST, SOUTH, WEST, NORTH, NONE };
+
+// used to say a jump found nothing (cell 0 is always part of the border)
+#define NO_JUMP 0
+
+
+///
+/// Function: distance
+///
+/// Description: Gets the Manhattan distance between two cells, which is the
+///              heuristic of both searches.
+///
+/// @param maze  The maze the cells are in.
+/// @param from  The packed index of one cell.
+/// @param to  The packed index of the other cell.
+///
+/// @return the Manhattan distance between the cells.
+///
+static uint32_t distance(Maze maze, uint32_t from, uint32_t to)
+{
+    size_t fromRow = from / maze->stride, toRow = to / maze->stride;
+    size_t fromCol = from % maze->stride, toCol = to % maze->stride;
+
+    return (uint32_t) (((fromRow > toRow) ? fromRow - toRow : toRow - fromRow) +
+                       ((fromCol > toCol) ? fromCol - toCol : toCol - fromCol));
+}
+
+
+///
+/// Function: makeKey
+///
+/// Description: Makes the heap key of an entry. Entries come out by lowest
+///              f = g + h, and on a tie by highest g (the deepest first).
+///
+/// @param g  The number of steps taken to get to the cell.
+/// @param h  The heuristic distance left from the cell.
+///
+/// @return the key of the entry.
+///
+static uint64_t makeKey(uint32_t g, uint32_t h)
+{
+    return ((uint64_t) (g + h) << 32) | (UINT32_MAX - g);
+}
+
+
+///
+/// Function: keySteps
+///
+/// Description: Gets g back out of a heap key made by makeKey.
+///
+static uint32_t keySteps(uint64_t key)
+{
+    return UINT32_MAX - (uint32_t) key;
+}
+
+
+/// finds the shortest path with A* and a Manhattan distance heuristic
+size_t solve_astar( Maze maze, uint32_t start, uint32_t goal )
+{
+    // waste of time if we can't get in/out of the maze
+    if(bit_test(maze->walls, goal) || bit_test(maze->walls, start))
+        return 0;
+
+    size_t steps = 0;
+
+    // the closed set (walls are closed from the start)
+    uint64_t *closed = maze_createVisitedMap(maze);
+
+    // the open set, ordered by f = g + h
+    Heap open = heap_create(2 * (maze->rows + maze->cols));
+    if(closed == NULL || open == NULL)
+    {
+        fprintf(stderr, "Unable to allocate a search of %zu words.\n",
+                maze->words);
+        exit(EXIT_FAILURE);
+    }
+    heap_insert(open, makeKey(0, distance(maze, start, goal)), start);
+
+    stat_search();
+    while(!heap_empty(open))
+    {
+        stat_expand(1, heap_size(open));
+        HNode best = heap_remove(open);
+        uint32_t cell = (uint32_t) best.value, g = keySteps(best.key);
+
+        // the heuristic is consistent, so the first time a cell comes out it
+        // has its shortest distance; any later copies are stale
+        if(bit_test(closed, cell))
+            continue;
+        bit_set(closed, cell);
+
+        // the goal has its shortest distance, counting the start cell
+        if(cell == goal)
+        {
+            steps = (size_t) g + 1;
+            break;
+        }
+
+        // the four neighbors of the cell
+        uint32_t neighbors[4] = {
+            maze_east(maze, cell),
+            maze_south(maze, cell),
+            maze_west(maze, cell),
+            maze_north(maze, cell)
+        };
+
+        for(int i = 0; i < 4; ++i)
+            if(!bit_test(closed, neighbors[i]))
+                heap_insert(open, makeKey(g + 1,
+                                          distance(maze, neighbors[i], goal)),
+                            neighbors[i]);
+    }
+
+    heap_destroy(open);
+    maze_clearVisitedMap(closed);
+
+    return steps;
+}
+
+
+///
+/// Function: isOpen
+///
+/// Description: Determines if a cell can be entered.
+///
+static inline bool isOpen(Maze maze, uint32_t cell)
+{
+    return !bit_test(maze->walls, cell);
+}
+
+
+///
+/// Function: jumpHorizontal
+///
+/// Description: Moves EAST or WEST from a cell until reaching a jump point: the
+///              goal, or a cell whose NORTH or SOUTH neighbor could not have
+///              been reached from the cell behind it (a forced neighbor).
+///
+/// @param maze  The maze being searched.
+/// @param cell  The cell to move from.
+/// @param step  +1 to move EAST, -1 to move WEST.
+/// @param goal  The cell we are looking for.
+///
+/// @return the jump point, or NO_JUMP if a wall was hit first.
+///
+static uint32_t jumpHorizontal(Maze maze, uint32_t cell, int32_t step,
+                               uint32_t goal)
+{
+    uint32_t down = (uint32_t) maze->stride;
+
+    for(;;)
+    {
+        cell += (uint32_t) step;
+
+        if(!isOpen(maze, cell))
+            return NO_JUMP;
+        if(cell == goal)
+            return cell;
+
+        // NORTH or SOUTH opens up here but was closed one cell back
+        uint32_t behind = cell - (uint32_t) step;
+        if((isOpen(maze, cell - down) && !isOpen(maze, behind - down)) ||
+           (isOpen(maze, cell + down) && !isOpen(maze, behind + down)))
+            return cell;
+    }
+}
+
+
+///
+/// Function: jumpVertical
+///
+/// Description: Moves NORTH or SOUTH from a cell until reaching a jump point:
+///              the goal, a cell with a forced EAST or WEST neighbor, or a cell
+///              from which a horizontal jump finds a jump point.
+///
+/// @param maze  The maze being searched.
+/// @param cell  The cell to move from.
+/// @param step  +stride to move SOUTH, -stride to move NORTH.
+/// @param goal  The cell we are looking for.
+///
+/// @return the jump point, or NO_JUMP if a wall was hit first.
+///
+static uint32_t jumpVertical(Maze maze, uint32_t cell, int32_t step,
+                             uint32_t goal)
+{
+    for(;;)
+    {
+        cell += (uint32_t) step;
+
+        if(!isOpen(maze, cell))
+            return NO_JUMP;
+        if(cell == goal)
+            return cell;
+
+        // EAST or WEST opens up here but was closed one cell back
+        uint32_t behind = cell - (uint32_t) step;
+        if((isOpen(maze, cell + 1) && !isOpen(maze, behind + 1)) ||
+           (isOpen(maze, cell - 1) && !isOpen(maze, behind - 1)))
+            return cell;
+
+        // every vertical step also looks along its row
+        if(jumpHorizontal(maze, cell, 1, goal) != NO_JUMP ||
+           jumpHorizontal(maze, cell, -1, goal) != NO_JUMP)
+            return cell;
+    }
+}
+
+
+/// finds the shortest path with Jump Point Search; only jump points ever go
+/// into the heap, the straight runs between them are skipped over
+size_t solve_jps( Maze maze, uint32_t start, uint32_t goal )
+{
+    // waste of time if we can't get in/out of the maze
+    if(bit_test(maze->walls, goal) || bit_test(maze->walls, start))
+        return 0;
+
+    size_t steps = 0;
+
+    // the step to the next cell in each direction
+    int32_t stride = (int32_t) maze->stride;
+    const int32_t moves[4] = { 1, stride, -1, -stride };
+
+    // the closed set (walls are closed from the start)
+    uint64_t *closed = maze_createVisitedMap(maze);
+
+    // the open set, ordered by f = g + h; each entry remembers the direction
+    // it was reached in, which decides which directions are worth a jump
+    Heap open = heap_create(2 * (maze->rows + maze->cols));
+    if(closed == NULL || open == NULL)
+    {
+        fprintf(stderr, "Unable to allocate a search of %zu words.\n",
+                maze->words);
+        exit(EXIT_FAILURE);
+    }
+    heap_insert(open, makeKey(0, distance(maze, start, goal)),
+                start | ((uint64_t) NONE << 32));
+
+    stat_search();
+    while(!heap_empty(open))
+    {
+        stat_expand(1, heap_size(open));
+        HNode best = heap_remove(open);
+        uint32_t cell = (uint32_t) best.value, g = keySteps(best.key);
+        int arrived = (int) (best.value >> 32);
+
+        if(bit_test(closed, cell))
+            continue;
+        bit_set(closed, cell);
+
+        if(cell == goal)
+        {
+            steps = (size_t) g + 1;
+            break;
+        }
+
+        for(int dir = EAST; dir <= NORTH; ++dir)
+        {
+            // never jumps back the way we came; the start goes every way
+            if(arrived != NONE && dir == (arrived + 2) % 4)
+                continue;
+
+            uint32_t jump = (dir == EAST || dir == WEST)
+                ? jumpHorizontal(maze, cell, moves[dir], goal)
+                : jumpVertical(maze, cell, moves[dir], goal);
+
+            if(jump == NO_JUMP || bit_test(closed, jump))
+                continue;
+
+            // the jump is a straight line so its length is the distance
+            uint32_t jumpG = g + distance(maze, cell, jump);
+            heap_insert(open, makeKey(jumpG, distance(maze, jump, goal)),
+                        jump | ((uint64_t) dir << 32));
+        }
+    }
+
+    heap_destroy(open);
+    maze_clearVisitedMap(closed);
+
+    return steps;
+}
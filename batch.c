@@ -0,0 +1,807 @@
+///
+/// File: batch.c
+///
+/// Description: Answers a stream of shortest path queries against one maze.
+///              Queries are read a batch at a time and sorted by source, so a
+///              single BFS from each source answers every query that shares it
+///              (the BFS stops once the last of its targets has been reached).
+///              The sources of a batch are shared out to a pool of threads,
+///              each with its own solver context, and the answers
+///              are written back out in the order the queries came in.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#define _GNU_SOURCE
+#include <pthread.h> // threads and barriers
+#include <stdbool.h> // boolean items
+#include <stdio.h> // reading queries, writing answers
+#include <stdlib.h> // allocation functions, qsort
+#include <string.h> // strspn, memchr, memmove, strerror
+#include <unistd.h> // read
+#include <errno.h> // EINTR
+#include <poll.h> // telling if more queries are waiting
+#include "batch.h" // the function we need to write is in here
+#include "context.h" // working space kept between searches
+#include "stats.h" // instrumentation counters
+
+
+// the number of queries read (and answered) at a time
+#define BATCH_QUERIES (1 << 16)
+
+// the number of bytes of queries read from their file at a time, at first
+#define READ_CHUNK (1 << 16)
+
+
+// one query that is worth searching for
+struct job_s{
+    // the packed indices of the cells the query is from and to
+    uint32_t source, target;
+    // where the query was in the batch (and so where its answer goes)
+    size_t index;
+};
+
+// the state shared by every thread of the pool
+struct pool_s{
+    // the maze being searched
+    Maze maze;
+    // the distance field queries from fieldSource are looked up in (or NULL)
+    DistField field;
+    uint32_t fieldSource;
+    // the queries of the current batch, sorted by source then target
+    struct job_s *jobs;
+    // the first job of every group of jobs sharing a source (the entry after
+    // the last group is the number of jobs)
+    size_t *groups;
+    size_t groupCount;
+    // the next group to be claimed
+    size_t cursor;
+    // the answer to every query of the batch, in the order they were read
+    size_t *steps;
+    // set once there are no more batches
+    bool done;
+    // the point every thread waits at between batches
+    pthread_barrier_t barrier;
+    // every thread of the pool
+    struct searcher_s *searchers;
+    unsigned threads;
+};
+
+// the state owned by one thread
+struct searcher_s{
+    pthread_t thread;
+    // the pool this thread is a part of
+    struct pool_s *pool;
+    // this thread's working space for searching
+    SolverContext ctx;
+    // the targets of the group being searched, laid out like the maze
+    uint64_t *targets;
+};
+
+// the queries still to be read, taken straight from their file (rather than
+// through its stream) so that it can be told whether more are waiting
+struct reader_s{
+    int fd;
+    // the bytes read but not yet taken are start up to end
+    char *buffer;
+    size_t start, end, capacity;
+    // set once the file has no more to give
+    bool finished;
+};
+
+// a pool of just the calling thread, kept from batch to batch
+struct batcher_s{
+    struct pool_s pool;
+    struct searcher_s searcher;
+    // the queries the batch arrays have room for, and the words of targets
+    size_t capacity, targetWords;
+};
+
+
+///
+/// Function: compareJobs
+///
+/// Description: Orders jobs by source, then by target, for qsort.
+///
+static int compareJobs(const void *a, const void *b)
+{
+    const struct job_s *left = a, *right = b;
+
+    if(left->source != right->source)
+        return (left->source < right->source) ? -1 : 1;
+    if(left->target != right->target)
+        return (left->target < right->target) ? -1 : 1;
+    return 0;
+}
+
+
+///
+/// Function: recordTarget
+///
+/// Description: Gives an answer to every job of a group going to one target.
+///
+/// @param *pool  The pool doing the searching.
+/// @param first  The first job of the group.
+/// @param last  One past the last job of the group.
+/// @param target  The target that was reached.
+/// @param steps  The number of steps to the target.
+///
+static void recordTarget(struct pool_s *pool, size_t first, size_t last,
+                         uint32_t target, size_t steps)
+{
+    // the jobs are sorted by target, so finds the first one going there...
+    size_t low = first, high = last;
+    while(low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if(pool->jobs[middle].target < target)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    // ...and answers it and every other one going there too
+    for(; low < last && pool->jobs[low].target == target; ++low)
+        pool->steps[pool->jobs[low].index] = steps;
+}
+
+
+///
+/// Function: answerGroup
+///
+/// Description: Answers every job of a group with one BFS from their source.
+///
+/// @param *searcher  The thread doing the searching.
+/// @param first  The first job of the group.
+/// @param last  One past the last job of the group.
+///
+static void answerGroup(struct searcher_s *searcher, size_t first, size_t last)
+{
+    struct pool_s *pool = searcher->pool;
+    Maze maze = pool->maze;
+    uint32_t source = pool->jobs[first].source;
+
+    // the distances from this source are already known
+    if(pool->field != NULL && source == pool->fieldSource)
+    {
+        for(size_t i = first; i < last; ++i)
+        {
+            uint32_t target = pool->jobs[i].target;
+            pool->steps[pool->jobs[i].index] =
+                dist_steps(pool->field, maze_row(maze, target),
+                           maze_col(maze, target));
+        }
+        return;
+    }
+
+    // marks the targets worth searching for; the rest are answered here
+    size_t remaining = 0;
+    for(size_t i = first; i < last; ++i)
+    {
+        uint32_t target = pool->jobs[i].target;
+        size_t index = pool->jobs[i].index;
+
+        if(bit_test(maze->walls, source) || bit_test(maze->walls, target))
+            pool->steps[index] = 0;
+        else if(target == source)
+            pool->steps[index] = 1;
+        else
+        {
+            pool->steps[index] = 0;
+            if(!bit_test(searcher->targets, target))
+            {
+                bit_set(searcher->targets, target);
+                ++remaining;
+            }
+        }
+    }
+
+    // the context starts over (the visitation map is brought up to date a
+    // row at a time as the search gets to it, not cleared)
+    SolverContext ctx = searcher->ctx;
+    if(remaining > 0)
+    {
+        // NOTE: the context was made for this maze, so it never has to grow
+        ctx_begin(ctx, maze);
+        ctx_touchRow(ctx, source / maze->stride);
+        que_insert(ctx->queue, source);
+        bit_set(ctx->visited, source);
+        stat_search();
+    }
+
+    // a level at a time, until every target has been reached
+    for(size_t levelSteps = 1; remaining > 0 && !que_empty(ctx->queue);
+        ++levelSteps)
+    {
+        stat_level(que_size(ctx->queue));
+        for(size_t levelSize = que_size(ctx->queue); levelSize > 0;
+            --levelSize)
+        {
+            uint32_t searching = que_remove(ctx->queue);
+            ctx_touchAround(ctx, searching);
+
+            uint32_t neighbors[4] = {
+                maze_east(maze, searching),
+                maze_south(maze, searching),
+                maze_west(maze, searching),
+                maze_north(maze, searching)
+            };
+
+            for(int i = 0; i < 4; ++i)
+                if(!bit_test(ctx->visited, neighbors[i]))
+                {
+                    que_insert(ctx->queue, neighbors[i]);
+                    bit_set(ctx->visited, neighbors[i]);
+
+                    // one of our targets, it is a step past this level
+                    if(bit_test(searcher->targets, neighbors[i]))
+                    {
+                        bit_clear(searcher->targets, neighbors[i]);
+                        recordTarget(pool, first, last, neighbors[i],
+                                     levelSteps + 1);
+                        --remaining;
+                    }
+                }
+        }
+    }
+
+    // any targets never reached are left marked, so unmarks them
+    for(size_t i = first; remaining > 0 && i < last; ++i)
+        bit_clear(searcher->targets, pool->jobs[i].target);
+}
+
+
+///
+/// Function: groupJobs
+///
+/// Description: Sorts the jobs of a batch by source and finds where each group
+///              sharing a source starts, ready to be claimed from the start.
+///
+/// @param *pool  The pool the batch is for.
+/// @param jobCount  The number of jobs in the batch.
+///
+static void groupJobs(struct pool_s *pool, size_t jobCount)
+{
+    qsort(pool->jobs, jobCount, sizeof(struct job_s), compareJobs);
+    pool->groupCount = 0;
+    for(size_t i = 0; i < jobCount; ++i)
+        if(i == 0 || pool->jobs[i].source != pool->jobs[i - 1].source)
+            pool->groups[pool->groupCount++] = i;
+    pool->groups[pool->groupCount] = jobCount;
+    pool->cursor = 0;
+}
+
+
+///
+/// Function: serveBatches
+///
+/// Description: The loop every thread of the pool runs, one batch at a time.
+///              The calling thread takes part too, but only for one batch, so
+///              it gets back to reading and writing in between.
+///
+/// @param *arg  The searcher_s of this thread.
+///
+/// @return NULL
+///
+static void * serveBatches(void *arg)
+{
+    struct searcher_s *searcher = arg;
+    struct pool_s *pool = searcher->pool;
+    bool caller = (searcher == &pool->searchers[0]);
+
+    for(;;)
+    {
+        // waits for a batch to be read in
+        if(!caller)
+            pthread_barrier_wait(&pool->barrier);
+        if(pool->done)
+            break;
+
+        // claims groups until there are none left
+        size_t group;
+        while((group = __atomic_fetch_add(&pool->cursor, 1, __ATOMIC_RELAXED))
+              < pool->groupCount)
+            answerGroup(searcher, pool->groups[group], pool->groups[group + 1]);
+
+        // waits for everyone to finish the batch
+        pthread_barrier_wait(&pool->barrier);
+
+        if(caller)
+            break;
+    }
+
+    // hands this thread's counts over before it exits
+    stat_flush();
+
+    return NULL;
+}
+
+
+///
+/// Function: readQuery
+///
+/// Description: Reads one query from a line.
+///
+/// @param maze  The maze the query is about.
+/// @param *line  The line holding the query.
+/// @param *job  Where the source and target of the query are stored.
+///
+/// @return true if the line holds a valid query; false otherwise.
+///
+static bool readQuery(Maze maze, const char *line, struct job_s *job)
+{
+    size_t r1, c1, r2, c2;
+    int used = 0;
+
+    // four numbers and nothing but whitespace after them
+    if(sscanf(line, "%zu %zu %zu %zu %n", &r1, &c1, &r2, &c2, &used) != 4 ||
+       line[used] != '\0')
+        return false;
+
+    if(r1 >= maze->rows || r2 >= maze->rows ||
+       c1 >= maze->cols || c2 >= maze->cols)
+        return false;
+
+    job->source = maze_cell(maze, r1, c1);
+    job->target = maze_cell(maze, r2, c2);
+    return true;
+}
+
+
+///
+/// Function: takeMemory
+///
+/// Description: Allocates memory the batch mode can't go on without.
+///
+/// @param size  The number of bytes needed.
+///
+/// @return the memory.
+///
+static void * takeMemory(size_t size)
+{
+    void *memory = malloc(size);
+
+    if(memory == NULL)
+    {
+        fprintf(stderr, "Unable to allocate %zu bytes for queries.\n", size);
+        exit(EXIT_FAILURE);
+    }
+
+    return memory;
+}
+
+
+///
+/// Function: readLine
+///
+/// Description: Takes the next line of queries, reading more of the file if
+///              the buffer doesn't hold all of it.
+///
+/// @param *reader  Where the queries are read from.
+///
+/// @return the line, without its newline (it is good until the next call),
+///         or NULL once there are no more.
+///
+static char * readLine(struct reader_s *reader)
+{
+    for(;;)
+    {
+        char *line = reader->buffer + reader->start;
+        char *newline = memchr(line, '\n', reader->end - reader->start);
+        if(newline != NULL || (reader->finished && reader->end > reader->start))
+        {
+            // the last line may have no newline, but there is always room
+            // after it for the terminator
+            char *after = (newline != NULL) ? newline
+                                            : reader->buffer + reader->end;
+            *after = '\0';
+            reader->start = (size_t) (after - reader->buffer) +
+                            (newline != NULL);
+            return line;
+        }
+        if(reader->finished)
+            return NULL;
+
+        // makes room behind what is left of the line (one byte is always
+        // kept free for its terminator)
+        memmove(reader->buffer, line, reader->end - reader->start);
+        reader->end -= reader->start;
+        reader->start = 0;
+        if(reader->capacity - reader->end < 2)
+        {
+            reader->capacity *= 2;
+            char *grown = realloc(reader->buffer, reader->capacity);
+            if(grown == NULL)
+            {
+                fprintf(stderr, "Unable to allocate %zu bytes for queries.\n",
+                        reader->capacity);
+                exit(EXIT_FAILURE);
+            }
+            reader->buffer = grown;
+        }
+
+        ssize_t got = read(reader->fd, reader->buffer + reader->end,
+                           reader->capacity - reader->end - 1);
+        if(got > 0)
+            reader->end += (size_t) got;
+        else if(got == 0 || errno != EINTR)
+            reader->finished = true;
+    }
+}
+
+
+///
+/// Function: wouldBlock
+///
+/// Description: Tells if taking another line would have to wait for one to
+///              be sent: there is no whole line left in the buffer, and
+///              nothing is waiting on the file. A regular file never waits.
+///
+/// @param *reader  Where the queries are read from.
+///
+/// @return true if the next line would wait; false otherwise.
+///
+static bool wouldBlock(const struct reader_s *reader)
+{
+    if(reader->finished ||
+       memchr(reader->buffer + reader->start, '\n',
+              reader->end - reader->start) != NULL)
+        return false;
+
+    struct pollfd waiting = { .fd = reader->fd, .events = POLLIN };
+    return poll(&waiting, 1, 0) == 0;
+}
+
+
+/// answers every query of a stream, a batch at a time
+void batch_run( Maze maze, DistField field, FILE *in, FILE *out,
+                unsigned threads )
+{
+    struct pool_s pool;
+    pool.maze = maze;
+    pool.field = field;
+    pool.fieldSource = (field != NULL)
+        ? maze_cell(maze, field->sourceRow, field->sourceCol) : 0;
+    pool.jobs = takeMemory(BATCH_QUERIES * sizeof(struct job_s));
+    pool.groups = takeMemory((BATCH_QUERIES + 1) * sizeof(size_t));
+    pool.steps = takeMemory(BATCH_QUERIES * sizeof(size_t));
+    pool.done = false;
+    pool.threads = threads;
+
+    // sets up every thread (the calling thread is searcher 0)
+    pool.searchers = calloc(threads, sizeof(struct searcher_s));
+    if(pool.searchers == NULL)
+    {
+        fprintf(stderr, "Unable to allocate %u searchers.\n", threads);
+        exit(EXIT_FAILURE);
+    }
+    int failed = pthread_barrier_init(&pool.barrier, NULL, threads);
+    if(failed != 0)
+    {
+        fprintf(stderr, "Unable to start search threads: %s\n",
+                strerror(failed));
+        exit(EXIT_FAILURE);
+    }
+    for(unsigned t = 0; t < threads; ++t)
+    {
+        struct searcher_s *searcher = &pool.searchers[t];
+        searcher->pool = &pool;
+        searcher->ctx = ctx_create(maze);
+        searcher->targets = calloc(maze->words, sizeof(uint64_t));
+        if(searcher->ctx == NULL || searcher->targets == NULL)
+        {
+            fprintf(stderr, "Unable to allocate searcher %u.\n", t);
+            exit(EXIT_FAILURE);
+        }
+
+        // every thread is needed at the barrier, we can't go on without one
+        if(t > 0 && (failed = pthread_create(&searcher->thread, NULL,
+                                             serveBatches, searcher)) != 0)
+        {
+            fprintf(stderr, "Unable to start search thread: %s\n",
+                    strerror(failed));
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    struct reader_s reader = { fileno(in), takeMemory(READ_CHUNK), 0, 0,
+                               READ_CHUNK, false };
+    bool more = true;
+
+    while(more)
+    {
+        // reads in a batch, skipping blank lines; a batch ends early once
+        // the queries stop coming, so someone sending them one at a time
+        // gets each answer before sending the next
+        size_t count = 0, jobCount = 0;
+        while(count < BATCH_QUERIES && !(count > 0 && wouldBlock(&reader)))
+        {
+            char *line = readLine(&reader);
+            if(line == NULL)
+            {
+                more = false;
+                break;
+            }
+
+            if(line[strspn(line, " \t\r\n")] == '\0')
+                continue;
+
+            if(readQuery(maze, line, &pool.jobs[jobCount]))
+            {
+                pool.jobs[jobCount++].index = count;
+                pool.steps[count] = 0;
+            }
+            else
+                pool.steps[count] = BATCH_INVALID;
+            ++count;
+        }
+
+        if(count == 0)
+            break;
+
+        groupJobs(&pool, jobCount);
+
+        // lets everyone loose on the batch and helps out
+        pthread_barrier_wait(&pool.barrier);
+        serveBatches(&pool.searchers[0]);
+
+        // writes the answers out in the order the queries came in
+        for(size_t i = 0; i < count; ++i)
+        {
+            if(pool.steps[i] == BATCH_INVALID)
+                fprintf(out, "Invalid query.\n");
+            else if(pool.steps[i] > 0)
+                fprintf(out, "Solution in %zu steps.\n", pool.steps[i]);
+            else
+                fprintf(out, "No solution.\n");
+        }
+        fflush(out);
+    }
+
+    // sends everyone home
+    pool.done = true;
+    pthread_barrier_wait(&pool.barrier);
+    for(unsigned t = 1; t < threads; ++t)
+        pthread_join(pool.searchers[t].thread, NULL);
+
+    // tears everything down
+    free(reader.buffer);
+    pthread_barrier_destroy(&pool.barrier);
+    for(unsigned t = 0; t < threads; ++t)
+    {
+        ctx_destroy(pool.searchers[t].ctx);
+        free(pool.searchers[t].targets);
+    }
+    free(pool.searchers);
+    free(pool.jobs);
+    free(pool.groups);
+    free(pool.steps);
+}
+
+
+/// the pool starts out empty, its arrays are made for the first batch
+Batcher batch_createBatcher( void )
+{
+    Batcher batcher = calloc(1, sizeof(struct batcher_s));
+    if(batcher == NULL)
+        return NULL;
+
+    batcher->pool.threads = 1;
+    batcher->searcher.pool = &batcher->pool;
+    return batcher;
+}
+
+
+/// frees the batch arrays and the batcher (the contexts were never its own)
+void batch_destroyBatcher( Batcher batcher )
+{
+    if(batcher == NULL)
+        return;
+
+    free(batcher->pool.jobs);
+    free(batcher->pool.groups);
+    free(batcher->pool.steps);
+    free(batcher->searcher.targets);
+    free(batcher);
+}
+
+
+/// reads every line as a query, then answers the batch as batch_run answers
+/// each of its batches, only all on the calling thread
+const size_t * batch_answerLines( Batcher batcher, SolverContext ctx,
+                                  Maze maze, char *text, size_t *count )
+{
+    struct pool_s *pool = &batcher->pool;
+    *count = 0;
+
+    // every query is a line, so there are never more than the lines
+    size_t lines = 1;
+    for(const char *c = strchr(text, '\n'); c != NULL; c = strchr(c + 1, '\n'))
+        ++lines;
+
+    // the arrays only ever grow, so this soon stops happening
+    if(lines > batcher->capacity)
+    {
+        struct job_s *jobs = realloc(pool->jobs, lines * sizeof(struct job_s));
+        if(jobs != NULL)
+            pool->jobs = jobs;
+        size_t *groups = realloc(pool->groups, (lines + 1) * sizeof(size_t));
+        if(groups != NULL)
+            pool->groups = groups;
+        size_t *steps = realloc(pool->steps, lines * sizeof(size_t));
+        if(steps != NULL)
+            pool->steps = steps;
+        if(jobs == NULL || groups == NULL || steps == NULL)
+            return NULL;
+        batcher->capacity = lines;
+    }
+    if(maze->words > batcher->targetWords)
+    {
+        free(batcher->searcher.targets);
+        batcher->targetWords = 0;
+        batcher->searcher.targets = calloc(maze->words, sizeof(uint64_t));
+        if(batcher->searcher.targets == NULL)
+            return NULL;
+        batcher->targetWords = maze->words;
+    }
+
+    // the context is grown now, since answerGroup takes it that it fits
+    if(!ctx_begin(ctx, maze))
+        return NULL;
+    batcher->searcher.ctx = ctx;
+    pool->maze = maze;
+    pool->field = NULL;
+
+    // reads in the batch, skipping blank lines
+    size_t jobCount = 0;
+    for(char *line = text; line != NULL; )
+    {
+        char *end = strchr(line, '\n');
+        if(end != NULL)
+            *end = '\0';
+
+        if(line[strspn(line, " \t\r")] != '\0')
+        {
+            if(readQuery(maze, line, &pool->jobs[jobCount]))
+            {
+                pool->jobs[jobCount++].index = *count;
+                pool->steps[*count] = 0;
+            }
+            else
+                pool->steps[*count] = BATCH_INVALID;
+            ++*count;
+        }
+
+        line = (end != NULL) ? end + 1 : NULL;
+    }
+
+    // one search for each source
+    groupJobs(pool, jobCount);
+    for(size_t group = 0; group < pool->groupCount; ++group)
+        answerGroup(&batcher->searcher, pool->groups[group],
+                    pool->groups[group + 1]);
+
+    return pool->steps;
+}
+
+
+/// answers every reachability query of a stream with a label comparison
+void batch_reach( Maze maze, Components comps, FILE *in, FILE *out )
+{
+    char *line = NULL;
+    size_t lineCapacity = 0;
+    struct job_s job;
+
+    while(getline(&line, &lineCapacity, in) != -1)
+    {
+        // blank lines aren't queries
+        if(line[strspn(line, " \t\r\n")] == '\0')
+            continue;
+
+        if(!readQuery(maze, line, &job))
+            fprintf(out, "Invalid query.\n");
+        else if(comp_connected(comps,
+                               maze_row(maze, job.source),
+                               maze_col(maze, job.source),
+                               maze_row(maze, job.target),
+                               maze_col(maze, job.target)))
+            fprintf(out, "Reachable.\n");
+        else
+            fprintf(out, "Not reachable.\n");
+    }
+
+    free(line);
+}
+
+
+/// answers every query of a stream through the abstract graph
+void batch_hier( Maze maze, Hierarchy hier, FILE *in, FILE *out )
+{
+    char *line = NULL;
+    size_t lineCapacity = 0;
+    struct job_s job;
+
+    while(getline(&line, &lineCapacity, in) != -1)
+    {
+        // blank lines aren't queries
+        if(line[strspn(line, " \t\r\n")] == '\0')
+            continue;
+
+        if(!readQuery(maze, line, &job))
+        {
+            fprintf(out, "Invalid query.\n");
+            continue;
+        }
+
+        size_t steps = hier_steps(hier, maze, job.source, job.target);
+        if(steps > 0)
+            fprintf(out, "Solution in %zu steps.\n", steps);
+        else
+            fprintf(out, "No solution.\n");
+    }
+
+    free(line);
+}
+
+
+///
+/// Function: readCell
+///
+/// Description: Reads the cell named at the end of a command.
+///
+/// @param maze  The maze the cell is in.
+/// @param *args  The rest of the command line.
+/// @param *row  Where the row is stored.
+/// @param *col  Where the column is stored.
+///
+/// @return true if args is a cell of the maze and nothing else.
+///
+static bool readCell(Maze maze, const char *args, size_t *row, size_t *col)
+{
+    int used = 0;
+
+    return sscanf(args, "%zu %zu %n", row, col, &used) == 2 &&
+           args[used] == '\0' && *row < maze->rows && *col < maze->cols;
+}
+
+
+/// runs toggle and query commands, keeping the distances as it goes
+void batch_edit( Dynamic dyn, FILE *in, FILE *out )
+{
+    Maze maze = dyn->maze;
+    char *line = NULL;
+    size_t lineCapacity = 0;
+
+    while(getline(&line, &lineCapacity, in) != -1)
+    {
+        // splits the command from its arguments
+        char *command = line + strspn(line, " \t\r\n");
+        size_t length = strcspn(command, " \t\r\n");
+        char *args = command + length;
+        args += strspn(args, " \t\r\n");
+
+        // blank lines aren't commands
+        if(length == 0)
+            continue;
+
+        size_t row = maze->rows - 1, col = maze->cols - 1;
+
+        if(length == 6 && strncmp(command, "toggle", 6) == 0 &&
+           readCell(maze, args, &row, &col))
+            dyn_toggle(dyn, row, col);
+        else if(length == 5 && strncmp(command, "query", 5) == 0 &&
+                (*args == '\0' || readCell(maze, args, &row, &col)))
+        {
+            size_t steps = dyn_steps(dyn, row, col);
+            if(steps > 0)
+                fprintf(out, "Solution in %zu steps.\n", steps);
+            else
+                fprintf(out, "No solution.\n");
+        }
+        else
+            fprintf(out, "Invalid command.\n");
+    }
+
+    free(line);
+}
@@ -0,0 +1,129 @@
+///
+/// File: batch.h
+///
+/// Description: Interface to the batch query mode, which answers a stream of
+///              shortest path queries against one Maze.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#ifndef _BATCH_H_
+#define _BATCH_H_
+
+#include <stdio.h>
+#include "maze.h"
+#include "distance.h"
+#include "components.h"
+#include "dynamic.h"
+#include "hierarchy.h"
+#include "context.h"
+
+// the answer batch_answerLines gives a line that isn't a valid query
+#define BATCH_INVALID SIZE_MAX
+
+// the working space for answering batches of queries on one thread
+typedef struct batcher_s * Batcher;
+
+///
+/// Answers every query read from a stream. Each line holds one query,
+/// "r1 c1 r2 c2", asking for the shortest path from (r1, c1) to (r2, c2);
+/// blank lines are skipped. Queries are read in batches: within a batch the
+/// queries sharing a source are answered by one BFS, and the sources are
+/// spread across a pool of threads. A batch ends when it is full or when no
+/// more queries are waiting to be read, and its answers are flushed then, so
+/// queries sent one at a time are answered as they come. Answers are written
+/// one per line, in the order the queries were read, as "Solution in N
+/// steps.", "No solution." or "Invalid query." (for a malformed line or a
+/// cell outside the maze).
+/// Queries from the source of a distance field are looked up, not searched.
+///
+/// @param maze  the maze the queries are about.
+/// @param field  a distance field of the maze, or NULL if there is none.
+/// @param in  the stream the queries are read from (they are read from its
+///            file descriptor, so nothing may have been read through the
+///            stream itself).
+/// @param out  the stream the answers are written to.
+/// @param threads  the number of threads to search with (at least 1).
+/// @exception If the memory for a batch or a thread cannot be had, the program
+///     terminates with an error message printed to the standard error
+///     output and an exit status of EXIT_FAILURE.
+///
+void batch_run( Maze maze, DistField field, FILE *in, FILE *out,
+                unsigned threads );
+
+///
+/// Create a Batcher, for answering batches of queries on the calling thread
+/// (its arrays are made when the first batch needs them, and only ever grow).
+///
+/// @return a Batcher instance, or NULL if the allocation fails.
+///
+Batcher batch_createBatcher( void );
+
+///
+/// Tear down and deallocate the supplied Batcher.
+///
+/// @param batcher - the Batcher to be deallocated.
+///
+void batch_destroyBatcher( Batcher batcher );
+
+///
+/// Answers a batch of queries held in text, the same way batch_run answers
+/// each of its batches (the queries sharing a source are answered by one
+/// BFS), but all on the calling thread. Each line holds one "r1 c1 r2 c2"
+/// query; blank lines are skipped.
+///
+/// @param batcher  the working space to answer with.
+/// @param ctx  the context to search with (it is grown if the maze needs it).
+/// @param maze  the maze the queries are about.
+/// @param text  the queries (NUL terminated; the new lines are overwritten).
+/// @param count  set to the number of queries read.
+///
+/// @return the answer to every query, in the order they were read (0 for no
+///         solution, BATCH_INVALID for a line that isn't a valid query),
+///         which lasts until the next batch; or NULL if the memory for the
+///         batch cannot be had.
+///
+const size_t * batch_answerLines( Batcher batcher, SolverContext ctx,
+                                  Maze maze, char *text, size_t *count );
+
+///
+/// Answers every reachability query read from a stream, by comparing labels.
+/// Queries are read just as batch_run reads them, and answered in order as
+/// "Reachable.", "Not reachable." or "Invalid query.".
+///
+/// @param maze  the maze the queries are about.
+/// @param comps  the labeling of the maze's regions.
+/// @param in  the stream the queries are read from.
+/// @param out  the stream the answers are written to.
+///
+void batch_reach( Maze maze, Components comps, FILE *in, FILE *out );
+
+///
+/// Answers every query read from a stream through the abstract graph of the
+/// maze, one at a time. Queries are read and answered just as batch_run
+/// reads and answers them.
+///
+/// @param maze  the maze the queries are about.
+/// @param hier  the abstract graph of the maze.
+/// @param in  the stream the queries are read from.
+/// @param out  the stream the answers are written to.
+///
+void batch_hier( Maze maze, Hierarchy hier, FILE *in, FILE *out );
+
+///
+/// Runs a stream of commands against a maze whose distances from the entrance
+/// are kept up to date as it changes. Each line is one command:
+///     "toggle r c"  turns (r, c) from open to wall or wall to open.
+///     "query"       answers how far the exit is from the entrance.
+///     "query r c"   answers how far (r, c) is from the entrance.
+/// Queries are answered as "Solution in N steps." or "No solution.", and any
+/// other line as "Invalid command."; blank lines are skipped.
+///
+/// @param dyn  the distances being kept (its maze is the one changed).
+/// @param in  the stream the commands are read from.
+/// @param out  the stream the answers are written to.
+///
+void batch_edit( Dynamic dyn, FILE *in, FILE *out );
+
+#endif
@@ -0,0 +1,342 @@
+///
+/// File: bench.c
+///
+/// Description: A benchmark harness that times the stages of solving
+///              generated mazes.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#define _GNU_SOURCE
+#include <stdbool.h> // boolean items
+#include <stdio.h> // result and error reporting
+#include <stdlib.h> // allocation functions, strtod
+#include <string.h> // strdup, strtok_r
+#include <time.h> // clock_gettime
+#include <sys/resource.h> // getrusage
+#include "bench.h" // benchmark functions and structures
+#include "generate.h" // the maze generators
+#include "fileRead.h" // reading the mazes back in
+#include "stats.h" // the heap in use
+
+// the cases "all" runs
+#define SUITE "open:10x10,random:10x10,backtracker:10x10,serpentine:10x10," \
+              "frontier:10x10,open:100x100,random:100x100," \
+              "backtracker:100x100,serpentine:100x100,frontier:100x100," \
+              "open:1000x1000,random:1000x1000,backtracker:1000x1000," \
+              "serpentine:1000x1000,frontier:1000x1000,open:4000x4000," \
+              "random:4000x4000,backtracker:4000x4000,serpentine:4000x4000," \
+              "frontier:4000x4000"
+
+// the cases "large" runs; kept out of "all" since the text of a 50000x50000
+// maze alone is 5 GB, which is written out, read back and printed per case
+#define LARGE_SUITE "open:10000x10000,random:10000x10000," \
+                    "backtracker:10000x10000,serpentine:10000x10000," \
+                    "frontier:10000x10000,open:50000x50000," \
+                    "random:50000x50000,backtracker:50000x50000," \
+                    "serpentine:50000x50000,frontier:50000x50000"
+
+// one case of a benchmark
+struct benchCase_s{
+    GenKind kind;
+    size_t rows, cols;
+    double density;
+    uint64_t seed;
+};
+
+
+///
+/// Function: now
+///
+/// Description: Gets the time on a clock that only moves forward.
+///
+/// @return the time, in seconds.
+///
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+
+///
+/// Function: resetPeak
+///
+/// Description: Resets the peak resident memory of the process to what is
+///              resident now, so the next peak read is that of one stage. Only
+///              Linux can do this; elsewhere nothing happens.
+///
+static void resetPeak(void)
+{
+    FILE *refs = fopen("/proc/self/clear_refs", "w");
+    if(refs != NULL)
+    {
+        fputs("5", refs);
+        fclose(refs);
+    }
+}
+
+
+///
+/// Function: peakKb
+///
+/// Description: Gets the peak resident memory of the process.
+///
+/// @return the peak, in kilobytes.
+///
+static size_t peakKb(void)
+{
+    // Linux keeps the peak since the last reset as VmHWM
+    FILE *status = fopen("/proc/self/status", "r");
+    if(status != NULL)
+    {
+        char line[128];
+        size_t kb = 0;
+        bool found = false;
+        while(!found && fgets(line, sizeof(line), status) != NULL)
+            found = sscanf(line, "VmHWM: %zu kB", &kb) == 1;
+        fclose(status);
+        if(found)
+            return kb;
+    }
+
+    // anywhere else only the peak of the whole run can be had
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    return (size_t) usage.ru_maxrss;
+}
+
+
+///
+/// Function: heapKb
+///
+/// Description: Gets the memory allocated from the heap and not yet freed.
+///
+/// @return the memory, in kilobytes (0 where it cannot be had).
+///
+static size_t heapKb(void)
+{
+    return stat_heapBytes() / 1024;
+}
+
+
+///
+/// Function: rate
+///
+/// Description: Works out the cells handled per second by a stage.
+///
+static double rate(size_t cells, double seconds)
+{
+    return (seconds > 0) ? (double) cells / seconds : 0;
+}
+
+
+///
+/// Function: parseFields
+///
+/// Description: Parses the fields of a case, cutting them out of its text.
+///
+static bool parseFields(char *text, struct benchCase_s *bench)
+{
+    char *rest = NULL;
+    char *kind = strtok_r(text, ":", &rest);
+    char *size = strtok_r(NULL, ":", &rest);
+    char *density = strtok_r(NULL, ":", &rest);
+    char *seed = strtok_r(NULL, ":", &rest);
+    char *end;
+
+    if(kind == NULL || size == NULL || strtok_r(NULL, ":", &rest) != NULL ||
+       !gen_parseKind(kind, &bench->kind))
+        return false;
+
+    bench->rows = (size_t) strtoull(size, &end, 10);
+    if(end == size || *end != 'x')
+        return false;
+    size = end + 1;
+    bench->cols = (size_t) strtoull(size, &end, 10);
+    if(end == size || *end != '\0' || bench->rows == 0 || bench->cols == 0)
+        return false;
+
+    bench->density = 0.3;
+    if(density != NULL)
+    {
+        bench->density = strtod(density, &end);
+        if(end == density || *end != '\0' ||
+           bench->density < 0 || bench->density > 1)
+            return false;
+    }
+
+    bench->seed = 1;
+    if(seed != NULL)
+    {
+        bench->seed = strtoull(seed, &end, 10);
+        if(end == seed || *end != '\0')
+            return false;
+    }
+
+    return true;
+}
+
+
+///
+/// Function: parseCase
+///
+/// Description: Parses one "KIND:ROWSxCOLS[:DENSITY[:SEED]]" case.
+///
+/// @param text  The case.
+/// @param bench  Where the case is stored.
+///
+/// @return true if the case is well formed; false otherwise (a message says
+///         so).
+///
+static bool parseCase(const char *text, struct benchCase_s *bench)
+{
+    // the fields are cut out of a copy, so the case is whole for the message
+    char *copy = strdup(text);
+    if(copy == NULL)
+        return false;
+
+    bool ok = parseFields(copy, bench);
+    if(!ok)
+        fprintf(stderr, "Bad benchmark case: %s\n", text);
+
+    free(copy);
+    return ok;
+}
+
+
+///
+/// Function: runCase
+///
+/// Description: Generates, reads, solves and prints one maze, timing each
+///              stage, and writes a line of results.
+///
+/// @param out  The stream the results are written to.
+/// @param bench  The case to run.
+/// @param stages  The stages to measure.
+///
+/// @return true if the case ran; false otherwise (a message says why).
+///
+static bool runCase(FILE *out, const struct benchCase_s *bench,
+                    const BenchStages *stages)
+{
+    size_t cells = bench->rows * bench->cols;
+
+    // generates the maze, and writes it out to be read back in
+    double start = now();
+    Maze maze = gen_create(bench->kind, bench->rows, bench->cols,
+                           bench->density, bench->seed);
+    double genSeconds = now() - start;
+    if(maze == NULL)
+    {
+        fprintf(stderr, "Unable to generate a %zu x %zu %s maze.\n",
+                bench->rows, bench->cols, gen_kindName(bench->kind));
+        return false;
+    }
+
+    FILE *text = tmpfile();
+    if(text == NULL || !gen_write(maze, text) || fflush(text) != 0)
+    {
+        perror("Error writing generated maze");
+        if(text != NULL)
+            fclose(text);
+        maze_destroy(maze);
+        return false;
+    }
+    rewind(text);
+
+    // only the hash is kept, so the copy read back in is the only one held
+    uint64_t hash = maze_hash(maze);
+    maze_destroy(maze);
+
+    // reads it back in, as a maze file is read (found in fileRead.c)
+    size_t heapBefore = heapKb();
+    resetPeak();
+    start = now();
+    maze = getMaze(text);
+    double parseSeconds = now() - start;
+    size_t parsePeak = peakKb();
+    fclose(text);
+    if(maze == NULL || maze_hash(maze) != hash)
+    {
+        fprintf(stderr, "The %zu x %zu %s maze did not read back in.\n",
+                bench->rows, bench->cols, gen_kindName(bench->kind));
+        maze_destroy(maze);
+        return false;
+    }
+    // (the heap can shrink, if reading freed more than the maze holds)
+    size_t heapAfter = heapKb();
+    size_t mazeHeap = (heapAfter > heapBefore) ? heapAfter - heapBefore : 0;
+
+    // solves it
+    resetPeak();
+    start = now();
+    size_t steps = stages->solve(maze, stages->settings);
+    double solveSeconds = now() - start;
+    size_t solvePeak = peakKb();
+
+    // pretty-prints it to nowhere
+    FILE *sink = fopen("/dev/null", "w");
+    if(sink == NULL)
+    {
+        perror("Error opening /dev/null");
+        maze_destroy(maze);
+        return false;
+    }
+    resetPeak();
+    start = now();
+    stages->print(sink, maze);
+    fflush(sink);
+    double printSeconds = now() - start;
+    size_t printPeak = peakKb();
+    fclose(sink);
+
+    maze_destroy(maze);
+
+    fprintf(out, "%s\t%zu\t%zu\t%g\t%llu\t%zu\t%.6f\t%.6f\t%.6f\t%.6f\t"
+            "%.0f\t%.0f\t%.0f\t%zu\t%zu\t%zu\t%zu\n",
+            gen_kindName(bench->kind), bench->rows, bench->cols,
+            bench->density, (unsigned long long) bench->seed, steps,
+            genSeconds, parseSeconds, solveSeconds, printSeconds,
+            rate(cells, parseSeconds), rate(cells, solveSeconds),
+            rate(cells, printSeconds), parsePeak, solvePeak, printPeak,
+            mazeHeap);
+    // each line is there as soon as its case is done
+    fflush(out);
+
+    return true;
+}
+
+
+/// runs each case of the comma separated list in turn
+bool bench_run( FILE *out, const char *cases, const BenchStages *stages )
+{
+    if(strcmp(cases, "all") == 0)
+        cases = SUITE;
+    else if(strcmp(cases, "large") == 0)
+        cases = LARGE_SUITE;
+
+    char *list = strdup(cases);
+    if(list == NULL)
+        return false;
+
+    fprintf(out, "kind\trows\tcols\tdensity\tseed\tsteps\t"
+            "gen_s\tparse_s\tsolve_s\tprint_s\t"
+            "parse_cells_s\tsolve_cells_s\tprint_cells_s\t"
+            "parse_peak_kb\tsolve_peak_kb\tprint_peak_kb\tmaze_heap_kb\n");
+
+    bool ok = true;
+    char *rest = NULL;
+    for(char *text = strtok_r(list, ",", &rest); ok && text != NULL;
+        text = strtok_r(NULL, ",", &rest))
+    {
+        struct benchCase_s bench;
+        ok = parseCase(text, &bench) && runCase(out, &bench, stages);
+    }
+
+    free(list);
+    return ok;
+}
@@ -0,0 +1,64 @@
+///
+/// File: bench.h
+///
+/// Description: Interface to the benchmark harness, which generates mazes and
+///              times reading, solving and printing each one separately.
+///
+///              A run is a comma separated list of cases, each
+///              "KIND:ROWSxCOLS[:DENSITY[:SEED]]" (KIND as gen_parseKind takes
+///              it; DENSITY defaults to 0.3 and SEED to 1), "all" for the
+///              standard suite: every kind at 10x10, 100x100, 1000x1000 and
+///              4000x4000, or "large" for every kind at 10000x10000 and
+///              50000x50000. The large sizes are not part of "all" because a
+///              50000x50000 maze is 5 GB of text, which takes minutes and as
+///              much disk to write out, read back and print. Every case is written out as text and read back in
+///              with getMaze, just as a maze file would be, then solved and
+///              pretty-printed (to /dev/null).
+///
+///              The results are tab separated, one line per case after a
+///              header line naming the columns:
+///                  kind rows cols density seed steps
+///                  gen_s parse_s solve_s print_s
+///                  parse_cells_s solve_cells_s print_cells_s
+///                  parse_peak_kb solve_peak_kb print_peak_kb maze_heap_kb
+///              The times are wall clock seconds; the rates are cells of the
+///              maze per second; the peaks are the most memory resident
+///              during each stage (on Linux the peak is reset before every
+///              stage; elsewhere it is the peak of the whole run so far); and
+///              maze_heap_kb is the heap the parsed maze holds.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "maze.h"
+
+// the stages of the program being measured
+typedef struct benchStages_s{
+    // solves a maze, giving the steps as findSolution does
+    size_t (*solve)(Maze maze, const void *settings);
+    // pretty-prints a maze
+    void (*print)(FILE *out, Maze maze);
+    // handed to solve as it is
+    const void *settings;
+} BenchStages;
+
+///
+/// Runs a benchmark and writes its results.
+///
+/// @param out  the stream the results are written to.
+/// @param cases  the cases to run (see above).
+/// @param stages  the stages to measure.
+///
+/// @return true if every case ran; false if one could not be parsed or a
+///         maze could not be made or read (a message says which).
+///
+bool bench_run( FILE *out, const char *cases, const BenchStages *stages );
+
+#endif
@@ -0,0 +1,161 @@
+///
+/// File: components.c
+///
+/// Description: Labels the connected open regions of a maze with a scan-line
+///              union-find. Every run of open cells in a row gets a temporary
+///              label, runs that touch across rows are joined, and a final
+///              pass gives each region one label.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#include <stdlib.h> // allocation functions
+#include "components.h" // component functions and structures
+
+
+// the first number of temporary labels we make room for
+#define MIN_LABELS 1024
+
+
+///
+/// Function: findRoot
+///
+/// Description: Finds the label at the root of a label's tree, halving the
+///              path to it on the way.
+///
+/// @param *parent  The parent of every temporary label.
+/// @param label  The label to find the root of.
+///
+/// @return the root label.
+///
+static uint32_t findRoot(uint32_t *parent, uint32_t label)
+{
+    while(parent[label] != label)
+    {
+        parent[label] = parent[parent[label]];
+        label = parent[label];
+    }
+
+    return label;
+}
+
+
+///
+/// Function: unite
+///
+/// Description: Joins the trees of two labels. The smaller root always becomes
+///              the parent, so a label's parent is never larger than it.
+///
+/// @param *parent  The parent of every temporary label.
+/// @param a  A label in one tree.
+/// @param b  A label in the other.
+///
+static void unite(uint32_t *parent, uint32_t a, uint32_t b)
+{
+    a = findRoot(parent, a);
+    b = findRoot(parent, b);
+
+    if(a < b)
+        parent[b] = a;
+    else if(b < a)
+        parent[a] = b;
+}
+
+
+/// labels every open region, one row of runs at a time
+Components comp_create( Maze maze )
+{
+    Components comps = malloc(sizeof(struct components_s));
+    if(comps == NULL)
+        return NULL;
+
+    comps->rows = maze->rows;
+    comps->cols = maze->cols;
+    comps->count = 0;
+    comps->labels = malloc(maze->rows * maze->cols * sizeof(uint32_t));
+
+    // label 0 is for walls and is its own parent
+    size_t capacity = MIN_LABELS, next = 1;
+    uint32_t *parent = malloc(capacity * sizeof(uint32_t));
+
+    if(comps->labels == NULL || parent == NULL)
+    {
+        free(parent);
+        comp_destroy(comps);
+        return NULL;
+    }
+    parent[0] = 0;
+
+    // FIRST PASS: labels the runs, joining each to the runs above it
+    for(size_t r = 0; r < maze->rows; ++r)
+    {
+        uint32_t *row = comps->labels + r * maze->cols;
+        const uint32_t *above = row - maze->cols;
+        uint32_t cell = maze_cell(maze, r, 0), current = 0;
+
+        for(size_t c = 0; c < maze->cols; ++c, ++cell)
+        {
+            if(bit_test(maze->walls, cell))
+            {
+                row[c] = 0;
+                current = 0;
+                continue;
+            }
+
+            // the start of a run gets a new label
+            if(current == 0)
+            {
+                if(next == capacity)
+                {
+                    uint32_t *bigger = realloc(parent, capacity * 2 *
+                                               sizeof(uint32_t));
+                    if(bigger == NULL)
+                    {
+                        free(parent);
+                        comp_destroy(comps);
+                        return NULL;
+                    }
+                    parent = bigger;
+                    capacity *= 2;
+                }
+
+                current = (uint32_t) next;
+                parent[next++] = current;
+            }
+            row[c] = current;
+
+            // joins the run above, once where each one starts to touch ours
+            if(r > 0 && above[c] != 0 &&
+               (c == 0 || above[c - 1] == 0 || row[c - 1] == 0))
+                unite(parent, current, above[c]);
+        }
+    }
+
+    // SECOND PASS: numbers the roots in order; every other label's parent is
+    // smaller than it, so its parent has already been given its final label
+    for(size_t label = 1; label < next; ++label)
+        parent[label] = (parent[label] == label)
+            ? (uint32_t) ++comps->count
+            : parent[parent[label]];
+
+    // THIRD PASS: relabels every cell with its region (walls stay 0)
+    for(size_t i = 0; i < maze->rows * maze->cols; ++i)
+        comps->labels[i] = parent[comps->labels[i]];
+
+    free(parent);
+
+    return comps;
+}
+
+
+/// frees the labels
+void comp_destroy( Components comps )
+{
+    // nothing to do for a labeling that was never made
+    if(comps == NULL)
+        return;
+
+    free(comps->labels);
+    free(comps);
+}
@@ -0,0 +1,83 @@
+///
+/// File: components.h
+///
+/// Description: Interface to the Components module, a labeling of the
+///              connected open regions of a Maze.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#ifndef _COMPONENTS_H_
+#define _COMPONENTS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "maze.h"
+
+// Components structure
+// NOTE: the labels are stored row-major, one uint32_t per cell with no
+//       padding; walls are labeled 0 and the open regions 1 to count, so two
+//       cells are connected exactly when they share a label that isn't 0
+typedef struct components_s{
+    // the number of rows and columns of the maze the labels are for
+    size_t rows, cols;
+    // the number of connected open regions
+    size_t count;
+    // the label of every cell
+    uint32_t *labels;
+} * Components;
+
+///
+/// Labels the connected open regions of a maze. Each row is scanned for runs
+/// of open cells, and every run is joined to the runs touching it in the row
+/// above with a union-find; the runs are then relabeled by region.
+///
+/// @param maze  the maze to label.
+///
+/// @return a Components instance, or NULL if the allocation fails.
+///
+Components comp_create( Maze maze );
+
+///
+/// Tear down and deallocate the supplied Components.
+///
+/// @param comps - the Components to be deallocated.
+///
+void comp_destroy( Components comps );
+
+///
+/// Gets the label of a cell.
+///
+/// @param comps  the labeling to look in.
+/// @param row  the row of the cell.
+/// @param col  the column of the cell.
+///
+/// @return 0 for a wall, otherwise the region the cell is in.
+///
+static inline uint32_t comp_label( const struct components_s *comps,
+                                   size_t row, size_t col )
+{
+    return comps->labels[row * comps->cols + col];
+}
+
+///
+/// Determines if one cell can be reached from another.
+///
+/// @param comps  the labeling to look in.
+/// @param r1  the row of the first cell.
+/// @param c1  the column of the first cell.
+/// @param r2  the row of the second cell.
+/// @param c2  the column of the second cell.
+///
+/// @return true if both cells are open and in the same region.
+///
+static inline bool comp_connected( const struct components_s *comps,
+                                   size_t r1, size_t c1, size_t r2, size_t c2 )
+{
+    uint32_t label = comp_label(comps, r1, c1);
+    return label != 0 && label == comp_label(comps, r2, c2);
+}
+
+#endif
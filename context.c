@@ -0,0 +1,197 @@
+///
+/// File: context.c
+///
+/// Description: The working space kept between searches, so a run of searches
+///              (a server's requests, a batch's sources) allocates once and
+///              never clears a whole visitation map.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#include <stdlib.h> // allocation functions
+#include <string.h> // memset
+#include "context.h" // context functions and structures
+
+
+///
+/// Function: destroyBitFrontier
+///
+/// Description: Frees a bitset frontier.
+///
+/// @param *frontier  The frontier to free.
+///
+static void destroyBitFrontier(struct bitFrontier_s *frontier)
+{
+    if(frontier == NULL)
+        return;
+
+    free(frontier->cells);
+    free(frontier->next);
+    for(int i = 0; i < 2; ++i)
+    {
+        free(frontier->first[i]);
+        free(frontier->last[i]);
+    }
+    free(frontier);
+}
+
+
+///
+/// Function: createBitFrontier
+///
+/// Description: Creates an (empty) bitset frontier for a bottom-up search.
+///
+/// @param rows  The number of rows of the maze being searched.
+/// @param stride  The number of bits in one of its padded rows.
+///
+/// @return the frontier, or NULL if the allocation fails.
+///
+static struct bitFrontier_s * createBitFrontier(size_t rows, size_t stride)
+{
+    struct bitFrontier_s *frontier = calloc(1, sizeof(struct bitFrontier_s));
+    if(frontier == NULL)
+        return NULL;
+
+    size_t words = (rows + 2) * stride / 64;
+    frontier->rowWords = stride / 64;
+    frontier->cells = calloc(words, sizeof(uint64_t));
+    frontier->next = calloc(words, sizeof(uint64_t));
+
+    // every row starts out with an empty window
+    for(int i = 0; i < 2; ++i)
+    {
+        frontier->first[i] = malloc((rows + 2) * sizeof(uint32_t));
+        frontier->last[i] = calloc(rows + 2, sizeof(uint32_t));
+        if(frontier->first[i] != NULL)
+            for(size_t r = 0; r < rows + 2; ++r)
+                frontier->first[i][r] = UINT32_MAX;
+    }
+
+    if(frontier->cells == NULL || frontier->next == NULL ||
+       frontier->first[0] == NULL || frontier->first[1] == NULL ||
+       frontier->last[0] == NULL || frontier->last[1] == NULL)
+    {
+        destroyBitFrontier(frontier);
+        return NULL;
+    }
+
+    return frontier;
+}
+
+
+/// makes a context with room for the maze
+SolverContext ctx_create( Maze maze )
+{
+    SolverContext ctx = calloc(1, sizeof(struct solverContext_s));
+    if(ctx == NULL)
+        return NULL;
+
+    ctx->queue = que_create(2 * (maze->rows + maze->cols));
+    if(ctx->queue == NULL || !ctx_begin(ctx, maze))
+    {
+        ctx_destroy(ctx);
+        return NULL;
+    }
+
+    return ctx;
+}
+
+
+/// frees the context and everything it holds
+void ctx_destroy( SolverContext ctx )
+{
+    // nothing to do for a context that was never made
+    if(ctx == NULL)
+        return;
+
+    free(ctx->visited);
+    free(ctx->stamps);
+    que_destroy(ctx->queue);
+    destroyBitFrontier(ctx->bits);
+    free(ctx);
+}
+
+
+/// moves on to a new stamp, growing first if the maze needs more room
+bool ctx_begin( SolverContext ctx, Maze maze )
+{
+    // a bigger maze than any before needs a bigger map...
+    if(maze->words > ctx->capacity)
+    {
+        free(ctx->visited);
+        ctx->visited = malloc(maze->words * sizeof(uint64_t));
+        ctx->capacity = (ctx->visited != NULL) ? maze->words : 0;
+        if(ctx->visited == NULL)
+            return false;
+    }
+
+    // ...or more stamps; the new ones start at 0, which no search ever uses
+    if(maze->rows + 2 > ctx->stampCapacity)
+    {
+        free(ctx->stamps);
+        ctx->stamps = calloc(maze->rows + 2, sizeof(uint32_t));
+        ctx->stampCapacity = (ctx->stamps != NULL) ? maze->rows + 2 : 0;
+        ctx->epoch = 0;
+        if(ctx->stamps == NULL)
+            return false;
+    }
+
+    // the bitsets are laid out by row, so a maze of another shape needs others
+    if(maze->rows != ctx->rows || maze->stride != ctx->stride)
+    {
+        destroyBitFrontier(ctx->bits);
+        ctx->bits = NULL;
+        ctx->rows = maze->rows;
+        ctx->stride = maze->stride;
+    }
+
+    // once every stamp has been used, they all start over
+    if(++ctx->epoch == 0)
+    {
+        memset(ctx->stamps, 0, ctx->stampCapacity * sizeof(uint32_t));
+        ctx->epoch = 1;
+    }
+
+    ctx->walls = maze->walls;
+    ctx->freshLow = ctx->freshHigh = 0;
+    que_clear(ctx->queue);
+
+    return true;
+}
+
+
+/// touches the three rows and grows the run of fresh rows to take them in
+void ctx_touchRows( SolverContext ctx, uint32_t cell )
+{
+    size_t row = cell / ctx->stride;
+
+    ctx_touchRow(ctx, row - 1);
+    ctx_touchRow(ctx, row);
+    ctx_touchRow(ctx, row + 1);
+
+    // joins the run if the rows are next to it, otherwise starts a new one
+    size_t low = (row - 1) * ctx->stride, high = (row + 2) * ctx->stride;
+    if(high < ctx->freshLow || low > ctx->freshHigh)
+    {
+        ctx->freshLow = low;
+        ctx->freshHigh = high;
+    }
+    else
+    {
+        if(low < ctx->freshLow)
+            ctx->freshLow = low;
+        if(high > ctx->freshHigh)
+            ctx->freshHigh = high;
+    }
+}
+
+
+/// makes the bitset frontier the first time it is asked for
+struct bitFrontier_s * ctx_frontier( SolverContext ctx )
+{
+    if(ctx->bits == NULL)
+        ctx->bits = createBitFrontier(ctx->rows, ctx->stride);
+
+    return ctx->bits;
+}
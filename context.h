@@ -0,0 +1,149 @@
+///
+/// File: context.h
+///
+/// Description: Interface to the SolverContext module, the working space a
+///              search needs (a visitation map, a frontier queue and the
+///              bitsets of a bottom-up step), kept from one search to the next.
+///
+///              The visitation map is never cleared between searches. Every
+///              row of it carries a stamp saying which search last wrote it;
+///              starting a search just moves on to a new stamp, and a row is
+///              copied from the maze's walls the first time the search comes
+///              near it. So a search only pays for the rows it gets to, and
+///              the cells in them are tested with the usual bit operations.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#ifndef _CONTEXT_H_
+#define _CONTEXT_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "maze.h"
+#include "queue.h"
+
+// the frontier of a BFS held as a bitset, for expanding bottom-up
+// NOTE: between searches every bit is clear and every window is empty
+struct bitFrontier_s{
+    // the frontier cells and the next frontier, laid out like the maze
+    uint64_t *cells, *next;
+    // for every padded row, the first and last word holding a frontier cell
+    // (first is UINT32_MAX for an empty row); [0] is cells, [1] is next
+    uint32_t *first[2], *last[2];
+    // the first and last padded rows the frontier spans
+    size_t lo, hi;
+    // the number of words in one padded row
+    size_t rowWords;
+    // the number of words the last step looked at
+    size_t scanned;
+};
+
+// SolverContext structure
+typedef struct solverContext_s{
+    // the walls of the maze being searched, and its shape
+    const uint64_t *walls;
+    size_t rows, stride;
+    // the number of words the visitation map has room for, and the number of
+    // (padded) rows there are stamps for
+    size_t capacity, stampCapacity;
+    // the visitation map, and the search that last wrote each of its rows
+    uint64_t *visited;
+    uint32_t *stamps;
+    // the stamp of the current search
+    uint32_t epoch;
+    // a run of rows known to be up to date, as the packed index of its first
+    // cell and one past its last (a search spreads out a row at a time, so
+    // this saves looking at the stamps for nearly every cell)
+    size_t freshLow, freshHigh;
+    // the frontier of a search
+    Queue queue;
+    // the frontier as bitsets (only made the first time a search needs it)
+    struct bitFrontier_s *bits;
+} * SolverContext;
+
+///
+/// Create a SolverContext with room to search a maze.
+///
+/// @param maze  the maze to size the context for (it may be used for other
+///              mazes later; it grows if one of them is larger).
+///
+/// @return a SolverContext instance, or NULL if the allocation fails.
+///
+SolverContext ctx_create( Maze maze );
+
+///
+/// Tear down and deallocate the supplied SolverContext.
+///
+/// @param ctx - the SolverContext to be deallocated.
+///
+void ctx_destroy( SolverContext ctx );
+
+///
+/// Starts a new search of a maze: every cell but the walls reads as unvisited
+/// and the queue is empty. Nothing is allocated or cleared unless the maze is
+/// larger than any searched with this context before (or, once every four
+/// billion searches, when the stamps run out and start over).
+///
+/// @param ctx  the context to search with.
+/// @param maze  the maze to be searched.
+///
+/// @return true if the context is ready; false if it had to grow and the
+///         allocation failed.
+///
+bool ctx_begin( SolverContext ctx, Maze maze );
+
+///
+/// Gets the bitset frontier of a context, making it the first time.
+///
+/// @param ctx  the context (ctx_begin must have been called).
+///
+/// @return the (empty) bitset frontier, or NULL if the allocation fails.
+///
+struct bitFrontier_s * ctx_frontier( SolverContext ctx );
+
+///
+/// Brings a (padded) row of the visitation map up to date for the current
+/// search, if an earlier search wrote it last.
+///
+/// @param ctx  the context being searched with.
+/// @param row  the padded row (0 and rows + 1 are the border).
+///
+static inline void ctx_touchRow( SolverContext ctx, size_t row )
+{
+    if(ctx->stamps[row] != ctx->epoch)
+    {
+        size_t rowWords = ctx->stride / 64;
+        memcpy(ctx->visited + row * rowWords, ctx->walls + row * rowWords,
+               rowWords * sizeof(uint64_t));
+        ctx->stamps[row] = ctx->epoch;
+    }
+}
+
+///
+/// Brings the rows of a cell and of its neighbors up to date (the slow half of
+/// ctx_touchAround, for when they aren't all in the run known to be).
+///
+/// @param ctx  the context being searched with.
+/// @param cell  the packed index of the cell (never in the border).
+///
+void ctx_touchRows( SolverContext ctx, uint32_t cell );
+
+///
+/// Brings the rows of a cell and of its neighbors up to date, so all five can
+/// be tested and marked in ctx->visited directly (walls and the border read
+/// as visited, as in any visitation map).
+///
+/// @param ctx  the context being searched with.
+/// @param cell  the packed index of the cell (never in the border).
+///
+static inline void ctx_touchAround( SolverContext ctx, uint32_t cell )
+{
+    if(cell < ctx->freshLow + ctx->stride || cell + ctx->stride >= ctx->freshHigh)
+        ctx_touchRows(ctx, cell);
+}
+
+#endif
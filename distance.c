@@ -0,0 +1,227 @@
+///
+/// File: distance.c
+///
+/// Description: The BFS distance from one source cell to every cell of a maze,
+///              and the binary file it is cached in. A cache file is a small
+///              header (which says what maze and source the field is for)
+///              followed by the distances exactly as they are held in memory,
+///              so loading one is just mapping it.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#include <stdio.h> // file writing, rename
+#include <stdlib.h> // allocation functions
+#include <string.h> // memcmp
+#include <fcntl.h> // open
+#include <unistd.h> // close
+#include <sys/mman.h> // mmap
+#include <sys/stat.h> // fstat
+#include "distance.h" // distance functions and structures
+#include "queue.h" // queue related items
+#include "stats.h" // instrumentation counters
+
+
+// the first bytes of every cache file (the last byte is the format version)
+static const char distMagic[8] = { 'M', 'O', 'P', 'D', 'I', 'S', 'T', 1 };
+
+// the header at the front of a cache file
+struct distHeader_s{
+    char magic[8];
+    // the maze_hash of the maze the field is for
+    uint64_t hash;
+    // the size of that maze
+    uint64_t rows, cols;
+    // the cell the distances are measured from
+    uint64_t sourceRow, sourceCol;
+};
+
+
+/// computes the distance to every cell with a BFS from the source
+DistField dist_create( Maze maze, size_t sourceRow, size_t sourceCol )
+{
+    DistField field = malloc(sizeof(struct distField_s));
+    if(field == NULL)
+        return NULL;
+
+    field->rows = maze->rows;
+    field->cols = maze->cols;
+    field->sourceRow = sourceRow;
+    field->sourceCol = sourceCol;
+    field->hash = maze_hash(maze);
+    field->mapping = NULL;
+    field->mappingLength = 0;
+
+    // every cell starts out unreachable
+    field->steps = calloc(maze->rows * maze->cols, sizeof(uint32_t));
+    if(field->steps == NULL)
+    {
+        free(field);
+        return NULL;
+    }
+
+    // a source in a wall reaches nothing, not even itself
+    uint32_t source = maze_cell(maze, sourceRow, sourceCol);
+    if(bit_test(maze->walls, source))
+        return field;
+
+    uint64_t *visited = maze_createVisitedMap(maze);
+    Queue q = que_create(2 * (maze->rows + maze->cols));
+    if(visited == NULL || q == NULL)
+    {
+        que_destroy(q);
+        maze_clearVisitedMap(visited);
+        free(field->steps);
+        free(field);
+        return NULL;
+    }
+
+    que_insert(q, source);
+    bit_set(visited, source);
+
+    // every cell of a level gets the same distance
+    stat_search();
+    for(uint32_t levelSteps = 1; !que_empty(q); ++levelSteps)
+    {
+        stat_level(que_size(q));
+        for(size_t levelSize = que_size(q); levelSize > 0; --levelSize)
+        {
+            uint32_t searching = que_remove(q);
+
+            field->steps[maze_row(maze, searching) * maze->cols +
+                         maze_col(maze, searching)] = levelSteps;
+
+            uint32_t neighbors[4] = {
+                maze_east(maze, searching),
+                maze_south(maze, searching),
+                maze_west(maze, searching),
+                maze_north(maze, searching)
+            };
+
+            for(int i = 0; i < 4; ++i)
+                if(!bit_test(visited, neighbors[i]))
+                {
+                    que_insert(q, neighbors[i]);
+                    bit_set(visited, neighbors[i]);
+                }
+        }
+    }
+
+    que_destroy(q);
+    maze_clearVisitedMap(visited);
+
+    return field;
+}
+
+
+/// maps a cache file, if it holds the field asked for
+DistField dist_load( const char *path, Maze maze,
+                     size_t sourceRow, size_t sourceCol )
+{
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+        return NULL;
+
+    // the file must be exactly a header and one distance per cell
+    struct stat info;
+    size_t length = sizeof(struct distHeader_s) +
+                    maze->rows * maze->cols * sizeof(uint32_t);
+    if(fstat(fd, &info) != 0 || (size_t) info.st_size != length)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    void *mapping = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(mapping == MAP_FAILED)
+        return NULL;
+
+    // the header has to match this maze and source
+    const struct distHeader_s *header = mapping;
+    if(memcmp(header->magic, distMagic, sizeof(distMagic)) != 0 ||
+       header->rows != maze->rows || header->cols != maze->cols ||
+       header->sourceRow != sourceRow || header->sourceCol != sourceCol ||
+       header->hash != maze_hash(maze))
+    {
+        munmap(mapping, length);
+        return NULL;
+    }
+
+    DistField field = malloc(sizeof(struct distField_s));
+    if(field == NULL)
+    {
+        munmap(mapping, length);
+        return NULL;
+    }
+
+    field->rows = maze->rows;
+    field->cols = maze->cols;
+    field->sourceRow = sourceRow;
+    field->sourceCol = sourceCol;
+    field->hash = header->hash;
+    field->steps = (uint32_t *) (header + 1);
+    field->mapping = mapping;
+    field->mappingLength = length;
+
+    return field;
+}
+
+
+/// writes a cache file beside path, then renames it into place
+bool dist_save( DistField field, const char *path )
+{
+    // the file we write to before it is finished
+    size_t pathLength = strlen(path);
+    char *partial = malloc(pathLength + sizeof(".partial"));
+    if(partial == NULL)
+        return false;
+    memcpy(partial, path, pathLength);
+    memcpy(partial + pathLength, ".partial", sizeof(".partial"));
+
+    FILE *out = fopen(partial, "wb");
+    if(out == NULL)
+    {
+        free(partial);
+        return false;
+    }
+
+    struct distHeader_s header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, distMagic, sizeof(distMagic));
+    header.hash = field->hash;
+    header.rows = field->rows;
+    header.cols = field->cols;
+    header.sourceRow = field->sourceRow;
+    header.sourceCol = field->sourceCol;
+
+    size_t cells = field->rows * field->cols;
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1 &&
+              fwrite(field->steps, sizeof(uint32_t), cells, out) == cells;
+
+    // a failed close means the data may never have made it out
+    ok = (fclose(out) == 0) && ok;
+    ok = ok && rename(partial, path) == 0;
+
+    if(!ok)
+        remove(partial);
+    free(partial);
+
+    return ok;
+}
+
+
+/// frees a distance field (or unmaps it, if it was loaded)
+void dist_destroy( DistField field )
+{
+    // nothing to do for a field that was never made
+    if(field == NULL)
+        return;
+
+    if(field->mapping != NULL)
+        munmap(field->mapping, field->mappingLength);
+    else
+        free(field->steps);
+    free(field);
+}
@@ -0,0 +1,100 @@
+///
+/// File: distance.h
+///
+/// Description: Interface to the DistField module, the BFS distance from one
+///              source cell to every cell of a Maze, which can be cached on
+///              disk next to the maze it was computed for.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#ifndef _DISTANCE_H_
+#define _DISTANCE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "maze.h"
+
+// DistField structure
+// NOTE: the distances are stored row-major, one uint32_t per cell with no
+//       padding, and hold the same counts the searches give: the number of
+//       cells on the shortest path from the source (so the source is 1), or 0
+//       for a cell that can't be reached
+typedef struct distField_s{
+    // the number of rows and columns of the maze the field is for
+    size_t rows, cols;
+    // the cell the distances are measured from
+    size_t sourceRow, sourceCol;
+    // the maze_hash of the maze the field is for
+    uint64_t hash;
+    // the distance to every cell
+    uint32_t *steps;
+    // the file mapping the distances live in (NULL if they were computed)
+    void *mapping;
+    size_t mappingLength;
+} * DistField;
+
+///
+/// Computes the distance from a source cell to every cell of a maze.
+///
+/// @param maze  the maze to measure.
+/// @param sourceRow  the row of the cell to measure from.
+/// @param sourceCol  the column of the cell to measure from.
+///
+/// @return a DistField instance, or NULL if the allocation fails.
+///
+DistField dist_create( Maze maze, size_t sourceRow, size_t sourceCol );
+
+///
+/// Loads a cached distance field, if the file holds one for this maze (by
+/// size and hash) and source. The file is mapped, not read, so only the
+/// distances that are looked up are ever brought in.
+///
+/// @param path  the cache file.
+/// @param maze  the maze the field must be for.
+/// @param sourceRow  the row of the cell the field must be measured from.
+/// @param sourceCol  the column of the cell the field must be measured from.
+///
+/// @return a DistField instance, or NULL if there is no such file or it does
+///         not hold the field asked for.
+///
+DistField dist_load( const char *path, Maze maze,
+                     size_t sourceRow, size_t sourceCol );
+
+///
+/// Saves a distance field to a cache file. The file is written beside path
+/// and renamed into place, so a reader never sees half of one.
+///
+/// @param field  the DistField to save.
+/// @param path  the cache file.
+///
+/// @return true if the file was written; false otherwise.
+///
+bool dist_save( DistField field, const char *path );
+
+///
+/// Looks up the distance to a cell.
+///
+/// @param field  the DistField to look in.
+/// @param row  the row of the cell.
+/// @param col  the column of the cell.
+///
+/// @return 0 if the cell can't be reached from the source, otherwise the
+///         number of cells on the shortest path to it (the source included).
+///
+static inline size_t dist_steps( const struct distField_s *field,
+                                 size_t row, size_t col )
+{
+    return field->steps[row * field->cols + col];
+}
+
+///
+/// Tear down and deallocate the supplied DistField.
+///
+/// @param field - the DistField to be deallocated.
+///
+void dist_destroy( DistField field );
+
+#endif
@@ -0,0 +1,340 @@
+///
+/// File: dynamic.c
+///
+/// Description: Keeps a BFS distance field up to date as the walls of a maze
+///              change, doing work in proportion to the cells whose distance
+///              actually changes rather than to the size of the maze.
+///
+///              Opening a cell can only shorten distances: the cell takes the
+///              best distance of its neighbors and the improvement spreads out
+///              a level at a time until it stops improving anything.
+///
+///              Closing a cell can only lengthen distances, and only for the
+///              cells all of whose shortest paths ran through it. Those are
+///              found a level at a time outward from the cell (a cell is
+///              affected if none of its parents, the neighbors one step closer
+///              to the source, are left unaffected). They are then measured
+///              again from the unaffected cells around them, closest first.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#include <stdio.h> // error reporting
+#include <stdlib.h> // allocation functions
+#include "dynamic.h" // dynamic functions and structures
+
+
+///
+/// Function: neighborsOf
+///
+/// Description: Gets the four neighbors of a cell.
+///
+/// @param maze  The maze the cell is in.
+/// @param cell  The packed index of the cell.
+/// @param *neighbors  Where the four neighbors are stored.
+///
+static inline void neighborsOf(Maze maze, uint32_t cell, uint32_t *neighbors)
+{
+    neighbors[0] = maze_east(maze, cell);
+    neighbors[1] = maze_south(maze, cell);
+    neighbors[2] = maze_west(maze, cell);
+    neighbors[3] = maze_north(maze, cell);
+}
+
+
+///
+/// Function: spreadFrom
+///
+/// Description: Spreads shorter distances out from the cells in the queue
+///              until they stop improving anything.
+///
+/// @param dyn  The Dynamic being updated.
+///
+/// @return the number of cells given a shorter distance.
+///
+static size_t spreadFrom(Dynamic dyn)
+{
+    Maze maze = dyn->maze;
+    size_t touched = 0;
+
+    while(!que_empty(dyn->queue))
+    {
+        uint32_t cell = que_remove(dyn->queue), next = dyn->dist[cell] + 1;
+        uint32_t neighbors[4];
+        neighborsOf(maze, cell, neighbors);
+
+        for(int i = 0; i < 4; ++i)
+        {
+            uint32_t neighbor = neighbors[i];
+            if(!bit_test(maze->walls, neighbor) &&
+               (dyn->dist[neighbor] == 0 || dyn->dist[neighbor] > next))
+            {
+                dyn->dist[neighbor] = next;
+                que_insert(dyn->queue, neighbor);
+                ++touched;
+            }
+        }
+    }
+
+    return touched;
+}
+
+
+///
+/// Function: hasParent
+///
+/// Description: Determines if a cell still has a neighbor one step closer to
+///              the source that isn't itself affected.
+///
+/// @param dyn  The Dynamic being updated.
+/// @param cell  The packed index of the cell.
+///
+/// @return true if the cell keeps its distance through such a neighbor.
+///
+static bool hasParent(Dynamic dyn, uint32_t cell)
+{
+    uint32_t neighbors[4];
+    neighborsOf(dyn->maze, cell, neighbors);
+
+    for(int i = 0; i < 4; ++i)
+        if(dyn->dist[neighbors[i]] + 1 == dyn->dist[cell] &&
+           !bit_test(dyn->affected, neighbors[i]) &&
+           !bit_test(dyn->maze->walls, neighbors[i]))
+            return true;
+
+    return false;
+}
+
+
+///
+/// Function: addAffected
+///
+/// Description: Marks a cell as affected and adds it to the list of them.
+///
+/// @param dyn  The Dynamic being updated.
+/// @param count  The number of cells in the list so far.
+/// @param cell  The packed index of the cell.
+///
+static void addAffected(Dynamic dyn, size_t count, uint32_t cell)
+{
+    if(count == dyn->cellCapacity)
+    {
+        size_t capacity = dyn->cellCapacity * 2;
+        uint32_t *cells = realloc(dyn->cells, capacity * sizeof(uint32_t));
+
+        // we cannot finish the update without space for the cells
+        if(cells == NULL)
+        {
+            fprintf(stderr, "Unable to grow update to %zu cells.\n", capacity);
+            exit(EXIT_FAILURE);
+        }
+
+        dyn->cells = cells;
+        dyn->cellCapacity = capacity;
+    }
+
+    dyn->cells[count] = cell;
+    bit_set(dyn->affected, cell);
+}
+
+
+///
+/// Function: closeCell
+///
+/// Description: Brings the distances up to date after a cell became a wall.
+///
+/// @param dyn  The Dynamic being updated.
+/// @param cell  The packed index of the cell that was closed.
+///
+/// @return the number of cells whose distance was looked at again.
+///
+static size_t closeCell(Dynamic dyn, uint32_t cell)
+{
+    Maze maze = dyn->maze;
+    uint32_t neighbors[4];
+
+    // the cell's own distance can go (nothing to do if it had none)
+    uint32_t old = dyn->dist[cell];
+    dyn->dist[cell] = 0;
+    if(old == 0)
+        return 0;
+
+    // FINDS THE AFFECTED CELLS, a level at a time out from the closed cell;
+    // a level is always decided before the one after it is looked at
+    size_t count = 0;
+    que_clear(dyn->queue);
+    neighborsOf(maze, cell, neighbors);
+    for(int i = 0; i < 4; ++i)
+        if(dyn->dist[neighbors[i]] == old + 1)
+            que_insert(dyn->queue, neighbors[i]);
+
+    while(!que_empty(dyn->queue))
+    {
+        uint32_t next = que_remove(dyn->queue);
+        if(bit_test(dyn->affected, next) || hasParent(dyn, next))
+            continue;
+
+        addAffected(dyn, count++, next);
+
+        // its children might have lost their only parent
+        neighborsOf(maze, next, neighbors);
+        for(int i = 0; i < 4; ++i)
+            if(dyn->dist[neighbors[i]] == dyn->dist[next] + 1)
+                que_insert(dyn->queue, neighbors[i]);
+    }
+
+    // MEASURES THEM AGAIN, first from the unaffected cells around them...
+    for(size_t i = 0; i < count; ++i)
+        dyn->dist[dyn->cells[i]] = 0;
+
+    heap_clear(dyn->heap);
+    for(size_t i = 0; i < count; ++i)
+    {
+        uint32_t best = 0;
+        neighborsOf(maze, dyn->cells[i], neighbors);
+        for(int n = 0; n < 4; ++n)
+        {
+            uint32_t dist = dyn->dist[neighbors[n]];
+            if(dist != 0 && !bit_test(dyn->affected, neighbors[n]) &&
+               (best == 0 || dist + 1 < best))
+                best = dist + 1;
+        }
+
+        if(best != 0)
+        {
+            dyn->dist[dyn->cells[i]] = best;
+            heap_insert(dyn->heap, best, dyn->cells[i]);
+        }
+    }
+
+    // ...then from each other, closest first
+    while(!heap_empty(dyn->heap))
+    {
+        HNode closest = heap_remove(dyn->heap);
+        uint32_t from = (uint32_t) closest.value;
+
+        // a stale entry, the cell got closer since
+        if(dyn->dist[from] != closest.key)
+            continue;
+
+        neighborsOf(maze, from, neighbors);
+        for(int i = 0; i < 4; ++i)
+            if(bit_test(dyn->affected, neighbors[i]) &&
+               (dyn->dist[neighbors[i]] == 0 ||
+                dyn->dist[neighbors[i]] > closest.key + 1))
+            {
+                dyn->dist[neighbors[i]] = (uint32_t) closest.key + 1;
+                heap_insert(dyn->heap, closest.key + 1, neighbors[i]);
+            }
+    }
+
+    // leaves the affected plane clear for the next update
+    for(size_t i = 0; i < count; ++i)
+        bit_clear(dyn->affected, dyn->cells[i]);
+
+    return count;
+}
+
+
+///
+/// Function: openCell
+///
+/// Description: Brings the distances up to date after a wall became open.
+///
+/// @param dyn  The Dynamic being updated.
+/// @param cell  The packed index of the cell that was opened.
+///
+/// @return the number of cells given a shorter distance.
+///
+static size_t openCell(Dynamic dyn, uint32_t cell)
+{
+    uint32_t neighbors[4], best = 0;
+
+    // the source is always 1 step, anything else is a step past its best
+    // neighbor (if it has any reachable neighbor at all)
+    if(cell == dyn->source)
+        best = 1;
+    else
+    {
+        neighborsOf(dyn->maze, cell, neighbors);
+        for(int i = 0; i < 4; ++i)
+        {
+            uint32_t dist = dyn->dist[neighbors[i]];
+            if(dist != 0 && (best == 0 || dist + 1 < best))
+                best = dist + 1;
+        }
+    }
+
+    dyn->dist[cell] = best;
+    if(best == 0)
+        return 0;
+
+    que_clear(dyn->queue);
+    que_insert(dyn->queue, cell);
+    return 1 + spreadFrom(dyn);
+}
+
+
+/// measures every cell from the source with one full BFS
+Dynamic dyn_create( Maze maze, size_t sourceRow, size_t sourceCol )
+{
+    Dynamic dyn = malloc(sizeof(struct dynamic_s));
+    if(dyn == NULL)
+        return NULL;
+
+    dyn->maze = maze;
+    dyn->source = maze_cell(maze, sourceRow, sourceCol);
+    dyn->dist = calloc(maze->words * 64, sizeof(uint32_t));
+    dyn->affected = calloc(maze->words, sizeof(uint64_t));
+    dyn->cellCapacity = 2 * (maze->rows + maze->cols);
+    dyn->cells = malloc(dyn->cellCapacity * sizeof(uint32_t));
+    dyn->queue = que_create(2 * (maze->rows + maze->cols));
+    dyn->heap = heap_create(2 * (maze->rows + maze->cols));
+
+    if(dyn->dist == NULL || dyn->affected == NULL || dyn->cells == NULL ||
+       dyn->queue == NULL || dyn->heap == NULL)
+    {
+        dyn_destroy(dyn);
+        return NULL;
+    }
+
+    // the first measurement is a BFS out from the source (a source in a wall
+    // reaches nothing)
+    if(!bit_test(maze->walls, dyn->source))
+        openCell(dyn, dyn->source);
+
+    return dyn;
+}
+
+
+/// frees the distances (but not the maze)
+void dyn_destroy( Dynamic dyn )
+{
+    // nothing to do for a Dynamic that was never made
+    if(dyn == NULL)
+        return;
+
+    free(dyn->dist);
+    free(dyn->affected);
+    free(dyn->cells);
+    que_destroy(dyn->queue);
+    heap_destroy(dyn->heap);
+    free(dyn);
+}
+
+
+/// flips a cell between wall and open and brings the distances up to date
+size_t dyn_toggle( Dynamic dyn, size_t row, size_t col )
+{
+    uint32_t cell = maze_cell(dyn->maze, row, col);
+
+    if(bit_test(dyn->maze->walls, cell))
+    {
+        bit_clear(dyn->maze->walls, cell);
+        return openCell(dyn, cell);
+    }
+
+    bit_set(dyn->maze->walls, cell);
+    return closeCell(dyn, cell);
+}
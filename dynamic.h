@@ -0,0 +1,98 @@
+///
+/// File: dynamic.h
+///
+/// Description: Interface to the Dynamic module, which keeps the BFS distance
+///              from one source to every cell of a Maze up to date as walls
+///              are added and removed.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#ifndef _DYNAMIC_H_
+#define _DYNAMIC_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "maze.h"
+#include "queue.h"
+#include "heap.h"
+
+// Dynamic structure
+// NOTE: the distances are kept by packed cell index (laid out like the maze,
+//       border and padding included) so neighbors are found the same way the
+//       searches find them; they hold the usual counts (the source is 1, and a
+//       wall or unreachable cell is 0)
+typedef struct dynamic_s{
+    // the maze being kept up with (its walls are changed by dyn_toggle)
+    Maze maze;
+    // the packed index of the cell the distances are measured from
+    uint32_t source;
+    // the distance to every cell
+    uint32_t *dist;
+    // the cells an update has marked as affected (all clear between updates)
+    uint64_t *affected;
+    // the cells an update has affected, in the order they were found
+    uint32_t *cells;
+    size_t cellCapacity;
+    // working space for updates
+    Queue queue;
+    Heap heap;
+} * Dynamic;
+
+///
+/// Computes the distance from a source cell to every cell of a maze, to be
+/// kept up to date from then on.
+///
+/// @param maze  the maze to measure; it must outlive the Dynamic, and should
+///              only be changed through dyn_toggle.
+/// @param sourceRow  the row of the cell to measure from.
+/// @param sourceCol  the column of the cell to measure from.
+///
+/// @return a Dynamic instance, or NULL if the allocation fails.
+///
+Dynamic dyn_create( Maze maze, size_t sourceRow, size_t sourceCol );
+
+///
+/// Tear down and deallocate the supplied Dynamic (the maze is left alone).
+///
+/// @param dyn - the Dynamic to be deallocated.
+///
+void dyn_destroy( Dynamic dyn );
+
+///
+/// Turns an open cell into a wall or a wall into an open cell, and brings the
+/// distances up to date. Only the cells whose distance can change are looked
+/// at: opening a cell spreads out from it only as far as distances drop, and
+/// closing one re-measures only the cells whose every shortest path went
+/// through it.
+///
+/// @param dyn  the Dynamic to update.
+/// @param row  the row of the cell to toggle.
+/// @param col  the column of the cell to toggle.
+///
+/// @return the number of cells whose distance was looked at again.
+/// @exception If the working space cannot be grown, the program terminates
+///     with an error message printed to the standard error output and an
+///     exit status of EXIT_FAILURE.
+///
+size_t dyn_toggle( Dynamic dyn, size_t row, size_t col );
+
+///
+/// Looks up the distance to a cell.
+///
+/// @param dyn  the Dynamic to look in.
+/// @param row  the row of the cell.
+/// @param col  the column of the cell.
+///
+/// @return 0 if the cell can't be reached from the source, otherwise the
+///         number of cells on the shortest path to it (the source included).
+///
+static inline size_t dyn_steps( const struct dynamic_s *dyn,
+                                size_t row, size_t col )
+{
+    return dyn->dist[maze_cell(dyn->maze, row, col)];
+}
+
+#endif
@@ -0,0 +1,313 @@
+///
+/// File: external.c
+///
+/// Description: An external memory BFS, for mazes too large to search in
+///              memory. The visitation map is a file mapped into memory, so
+///              the kernel can write it back and drop it like the wall plane
+///              of a mapped binary maze, and the frontiers are files too.
+///
+///              Every frontier is kept sorted by cell (so by row). The next
+///              one is made by reading the current one four times at once,
+///              a cursor per direction: each cursor's cells shifted one step
+///              north, west, east or south are still sorted, so merging the
+///              four streams gives every neighbor in order. The frontier files
+///              are then read and written front to back, and the wall plane
+///              and visitation map are swept from top to bottom once a level.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#define _GNU_SOURCE
+#include <errno.h> // EINTR
+#include <stdbool.h> // boolean items
+#include <stdio.h> // error reporting
+#include <stdlib.h> // allocation functions, mkstemp
+#include <string.h> // strlen
+#include <unistd.h> // pread, pwrite, ftruncate, unlink
+#include <sys/mman.h> // mmap
+#include "solve.h" // the function we need to write is in here
+#include "stats.h" // instrumentation counters
+
+// the cells every cursor and writer keeps in memory (256 KiB each)
+#define EXT_BUFFER 65536
+
+// reads one frontier file front to back, giving its cells moved one step
+struct cursor_s{
+    // the file, the number of cells in it and the next one to read
+    int fd;
+    uint64_t count, next;
+    // the step added to every cell
+    uint32_t delta;
+    // the cells read in but not yet given
+    uint32_t buffer[EXT_BUFFER];
+    size_t at, length;
+};
+
+// writes one frontier file front to back
+struct writer_s{
+    int fd;
+    // the number of cells written out so far
+    uint64_t count;
+    // the cells not yet written out
+    uint32_t buffer[EXT_BUFFER];
+    size_t length;
+};
+
+
+///
+/// Function: fail
+///
+/// Description: Reports a failed system call and terminates.
+///
+/// @param what  What was being done.
+///
+static void fail(const char *what)
+{
+    perror(what);
+    exit(EXIT_FAILURE);
+}
+
+
+///
+/// Function: createFile
+///
+/// Description: Creates a scratch file in a directory. It is unlinked at once,
+///              so it goes away when it is closed, even if we are killed.
+///
+/// @param dir  The directory to make the file in.
+///
+/// @return the file descriptor of the file.
+///
+static int createFile(const char *dir)
+{
+    char *path = malloc(strlen(dir) + sizeof("/mopsolver-XXXXXX"));
+    if(path == NULL)
+        fail("Error creating scratch file");
+    strcpy(path, dir);
+    strcat(path, "/mopsolver-XXXXXX");
+
+    int fd = mkstemp(path);
+    if(fd < 0)
+        fail("Error creating scratch file");
+    unlink(path);
+    free(path);
+
+    return fd;
+}
+
+
+///
+/// Function: fill
+///
+/// Description: Reads the next buffer of cells into a cursor.
+///
+/// @param cursor  The cursor to fill.
+///
+/// @return true if there were cells left to read; false otherwise.
+///
+static bool fill(struct cursor_s *cursor)
+{
+    if(cursor->next >= cursor->count)
+        return false;
+
+    size_t want = EXT_BUFFER;
+    if(cursor->count - cursor->next < want)
+        want = (size_t) (cursor->count - cursor->next);
+
+    char *into = (char *) cursor->buffer;
+    size_t have = 0, bytes = want * sizeof(uint32_t);
+    while(have < bytes)
+    {
+        ssize_t got = pread(cursor->fd, into + have, bytes - have,
+                            (off_t) (cursor->next * sizeof(uint32_t) + have));
+        if(got < 0 && errno == EINTR)
+            continue;
+        if(got <= 0)
+            fail("Error reading frontier");
+        have += (size_t) got;
+    }
+
+    cursor->next += want;
+    cursor->at = 0;
+    cursor->length = want;
+    return true;
+}
+
+
+///
+/// Function: peek
+///
+/// Description: Gets the next cell a cursor gives, without taking it.
+///
+/// @param cursor  The cursor to look at.
+/// @param cell  Set to the cell, if there is one.
+///
+/// @return true if there is a cell; false if the cursor is done.
+///
+static inline bool peek(struct cursor_s *cursor, uint32_t *cell)
+{
+    if(cursor->at == cursor->length && !fill(cursor))
+        return false;
+
+    *cell = cursor->buffer[cursor->at] + cursor->delta;
+    return true;
+}
+
+
+///
+/// Function: flush
+///
+/// Description: Writes the cells a writer holds out to its file.
+///
+/// @param writer  The writer to flush.
+///
+static void flush(struct writer_s *writer)
+{
+    const char *from = (const char *) writer->buffer;
+    size_t done = 0, bytes = writer->length * sizeof(uint32_t);
+    off_t offset = (off_t) (writer->count * sizeof(uint32_t));
+
+    while(done < bytes)
+    {
+        ssize_t put = pwrite(writer->fd, from + done, bytes - done,
+                             offset + (off_t) done);
+        if(put < 0 && errno == EINTR)
+            continue;
+        if(put <= 0)
+            fail("Error writing frontier");
+        done += (size_t) put;
+    }
+
+    writer->count += writer->length;
+    writer->length = 0;
+}
+
+
+///
+/// Function: append
+///
+/// Description: Adds a cell to the end of the frontier a writer is writing.
+///
+static inline void append(struct writer_s *writer, uint32_t cell)
+{
+    if(writer->length == EXT_BUFFER)
+        flush(writer);
+    writer->buffer[writer->length++] = cell;
+}
+
+
+/// searches level by level, each level a merge of the last one's four shifts
+size_t solve_external( Maze maze, uint32_t start, uint32_t goal,
+                       const char *dir )
+{
+    // waste of time if we can't get in/out of the maze
+    if(bit_test(maze->walls, goal) || bit_test(maze->walls, start))
+        return 0;
+
+    // if we start on the goal, we're already done
+    if(start == goal)
+        return 1;
+
+    // the visitation map starts (and, as a sparse file, stays) all zeros
+    // until it is written; walls are tested in the wall plane instead of
+    // being copied into it
+    size_t mapLength = maze->words * sizeof(uint64_t);
+    int mapFd = createFile(dir);
+    if(ftruncate(mapFd, (off_t) mapLength) != 0)
+        fail("Error creating visitation map");
+    uint64_t *visited = mmap(NULL, mapLength, PROT_READ | PROT_WRITE,
+                             MAP_SHARED, mapFd, 0);
+    if(visited == MAP_FAILED)
+        fail("Error mapping visitation map");
+
+    // the frontier being read, and the one being written
+    int current = createFile(dir), next = createFile(dir);
+    struct cursor_s *cursors = malloc(4 * sizeof(struct cursor_s));
+    struct writer_s *writer = malloc(sizeof(struct writer_s));
+    if(cursors == NULL || writer == NULL)
+    {
+        fprintf(stderr, "Unable to allocate the frontier buffers.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // the steps NORTH, WEST, EAST and SOUTH, in that order so each shifted
+    // copy of a sorted frontier stays sorted
+    const uint32_t deltas[4] = {
+        (uint32_t) -maze->stride, (uint32_t) -1, 1, (uint32_t) maze->stride
+    };
+
+    // the first frontier is the start alone
+    writer->fd = current;
+    writer->count = writer->length = 0;
+    append(writer, start);
+    flush(writer);
+    uint64_t frontier = writer->count;
+    bit_set(visited, start);
+
+    // the number of steps (0 until the goal is found)
+    size_t steps = 0;
+
+    stat_search();
+    for(size_t levelSteps = 1; steps == 0 && frontier > 0; ++levelSteps)
+    {
+        stat_level((size_t) frontier);
+        for(int d = 0; d < 4; ++d)
+        {
+            cursors[d].fd = current;
+            cursors[d].count = frontier;
+            cursors[d].next = 0;
+            cursors[d].delta = deltas[d];
+            cursors[d].at = cursors[d].length = 0;
+        }
+        writer->fd = next;
+        writer->count = writer->length = 0;
+
+        // merges the four shifted frontiers, smallest cell first
+        for(;;)
+        {
+            int least = -1;
+            uint32_t cell = 0, candidate;
+            for(int d = 0; d < 4; ++d)
+                if(peek(&cursors[d], &candidate) &&
+                   (least < 0 || candidate < cell))
+                {
+                    least = d;
+                    cell = candidate;
+                }
+            if(least < 0)
+                break;
+            ++cursors[least].at;
+
+            // a cell reached from two sides is seen twice, one after another
+            if(!bit_test(maze->walls, cell) && !bit_test(visited, cell))
+            {
+                bit_set(visited, cell);
+                append(writer, cell);
+            }
+        }
+        flush(writer);
+
+        // the goal was reached in this level
+        if(bit_test(visited, goal))
+            steps = levelSteps + 1;
+
+        // the next frontier becomes the current one, and the old one's
+        // space is handed back
+        int swap = current;
+        current = next;
+        next = swap;
+        frontier = writer->count;
+        if(ftruncate(next, 0) != 0)
+            fail("Error truncating frontier");
+    }
+
+    free(cursors);
+    free(writer);
+    close(current);
+    close(next);
+    munmap(visited, mapLength);
+    close(mapFd);
+
+    return steps;
+}
@@ -3,6 +3,8 @@
 ///
 /// Description: Used to read in a maze for mopsolver to solve. Uses two methods
 ///              determined by the method of input (stdin vs. separate file).
+///              Both methods parse the text straight into a bit-packed Maze.
+///              Binary maze files (see mazeFile.c) are handed off as they are.
 ///
 /// @author kjb2503 : Kevin Becker
 ///
@@ -12,89 +14,432 @@
 #include <stdio.h> // printing
 #include <string.h> // string functions
 #include <stdlib.h> // allocation functions
+#include <stdbool.h> // boolean items
+#include <unistd.h> // close
+#include <sys/mman.h> // mmap
+#include <sys/stat.h> // fstat
 #include "fileRead.h" // the function we need to write is in here
+#include "parseRow.h" // the row parsing kernels
+#include "mazeFile.h" // binary maze files
+#include "stats.h" // instrumentation counters
 
 
+// the size of the blocks a stream is read in
+#define READ_BLOCK (1 << 20)
+
+// the layout shared by every line of a maze
+struct layout_s{
+    // the number of columns in each line
+    size_t cols;
+    // the length of each line, not counting the new line
+    size_t lineLength;
+    // whether each line ends with an extra space
+    bool trailingSpace;
+};
+
+// the rows of a maze read in from a stream so far
+struct rows_s{
+    // the layout of the lines
+    struct layout_s layout;
+    // the packed walls of each row, rowWords words per row
+    uint64_t *grid;
+    // the number of words in each row of bits
+    size_t rowWords;
+    // the number of rows read and the number there is room for
+    size_t count, capacity;
+};
+
+
+///
+/// Function: parseLayout
 ///
-/// Function: fileStringCat
+/// Description: Works out the layout every line of the maze shares from the
+///              first one: cols digits separated by single spaces, an optional
+///              trailing space and a new line (which the last line may leave
+///              off).
 ///
-/// Description: Used to concatenate the existing string with a newly read in line.
+/// @param *line  The first line of the maze.
+/// @param lineLength  The length of that line, not counting its new line.
 ///
-/// @param ** fileString  The existing fileString to be added to.
-/// @param *str  The string to add to fileString.
+/// @return the layout of the lines.
 ///
-static void fileStringCat(char **fileString, char *str)
+static struct layout_s parseLayout(const char *line, size_t lineLength)
 {
-    // computes the new size of the fileString
-    size_t newSize = (strlen(*fileString) + strlen(str) + 1);
+    struct layout_s layout;
+
+    // whether each line ends with an extra space
+    layout.trailingSpace = line[lineLength - 1] == ' ';
+    // "0 0 0" has 3 columns in 5 characters
+    layout.cols = (lineLength - layout.trailingSpace + 1) / 2;
+    layout.lineLength = lineLength;
+
+    return layout;
+}
 
-    // resizes the fileString
-    *fileString = realloc(*fileString, newSize);
 
-    //concatenates the strings together
-    strcat(*fileString, str);
+///
+/// Function: parseLine
+///
+/// Description: Parses one line of the maze, checking it is laid out like the
+///              first (the new line, if any, is checked by the caller).
+///
+/// @param *line  The start of the line to parse.
+/// @param *layout  The layout of the lines.
+/// @param *bits  Where the walls are written.
+///
+/// @return true if the line was well formed; false otherwise.
+///
+static bool parseLine(const char *line,
+                      const struct layout_s *layout,
+                      uint64_t *bits)
+{
+    return parseRow(line, layout->cols, bits) &&
+           (!layout->trailingSpace || line[layout->lineLength - 1] == ' ');
 }
 
+
 ///
-/// Function: readFromStdin
+/// Function: parseMaze
 ///
-/// Description: The function used to read in a string from stdin.
+/// Description: Parses a whole maze held in memory.
 ///
-/// @return A string read in from the stdin buffer.
+/// @param *text  The maze text (need not be NUL terminated).
+/// @param length  The number of characters in the text.
 ///
-static char * readFromStdin()
+/// @return the maze, or NULL if it could not be parsed.
+///
+static Maze parseMaze(const char *text, size_t length)
 {
-    // the line buffer getline will write to
-    char *buf = NULL;
-    // the line size which getline will change
-    size_t bufsize = 0;
-    // allocates our empty file string
-    char *fileString = malloc(strlen("") +1);
-    // copies in an empty string
-    strcpy(fileString, "");
+    // blank lines at the end are not rows (a stream drops them the same way)
+    while(length > 0 && text[length - 1] == '\n')
+        --length;
+
+    // finds the end of the first line, this tells us the layout of every line
+    const char *newline = memchr(text, '\n', length);
+    size_t lineLength = (newline != NULL) ? (size_t) (newline - text) : length;
+
+    // if there is no maze to build from, there's nothing to do
+    if(lineLength == 0)
+    {
+        printf("No maze specified.\n");
+        return NULL;
+    }
+
+    struct layout_s layout = parseLayout(text, lineLength);
+    // every line (including its new line) is the same length
+    size_t lineStride = lineLength + 1;
+    // the last line may not have a new line at the end
+    size_t rows = (length + 1) / lineStride;
+
+    // makes our maze with every cell open
+    Maze maze = maze_create(rows, layout.cols);
+    if(maze == NULL)
+    {
+        fprintf(stderr, "Unable to build a %zu x %zu maze.\n",
+                rows, layout.cols);
+        return NULL;
+    }
+
+    // the scratch space one row of bits is parsed into
+    uint64_t *bits = calloc((layout.cols + 63) / 64, sizeof(uint64_t));
+
+    // parses each row straight into the maze
+    for(size_t r = 0; r < rows; ++r)
+    {
+        size_t end = r * lineStride + lineLength;
+
+        // the row must be well formed and end where the first one did
+        if(bits == NULL || !parseLine(text + r * lineStride, &layout, bits) ||
+           (end < length && text[end] != '\n'))
+        {
+            fprintf(stderr, "Malformed maze at row %zu.\n", r);
+            free(bits);
+            maze_destroy(maze);
+            return NULL;
+        }
+
+        maze_fillRow(maze, r, bits);
+    }
+
+    free(bits);
+
+    // anything after the last row is a row cut short
+    if(rows * lineStride < length)
+    {
+        fprintf(stderr, "Malformed maze at row %zu.\n", rows);
+        maze_destroy(maze);
+        return NULL;
+    }
+
+    return maze;
+}
+
+
+///
+/// Function: buildMaze
+///
+/// Description: Builds a maze out of rows of bits parsed from a stream.
+///
+/// @param *grid  The packed rows of walls, rowWords words per row.
+/// @param rows  The number of rows parsed.
+/// @param cols  The number of columns in each row.
+///
+/// @return the maze, or NULL if it could not be created.
+///
+static Maze buildMaze(const uint64_t *grid, size_t rows, size_t cols)
+{
+    size_t rowWords = (cols + 63) / 64;
+    Maze maze = maze_create(rows, cols);
+
+    if(maze == NULL)
+    {
+        fprintf(stderr, "Unable to build a %zu x %zu maze.\n", rows, cols);
+        return NULL;
+    }
+
+    // copies in each row of walls
+    for(size_t r = 0; r < rows; ++r)
+        maze_fillRow(maze, r, grid + r * rowWords);
+
+    return maze;
+}
+
+
+///
+/// Function: appendRow
+///
+/// Description: Parses one line read from a stream onto the end of the rows of
+///              bits read so far, growing them geometrically when full.
+///
+/// @param *rows  The rows read so far.
+/// @param *line  The line to parse.
+/// @param length  The number of characters left in the buffer at line.
+///
+/// @return true if the line was well formed; false otherwise.
+///
+static bool appendRow(struct rows_s *rows, const char *line, size_t length)
+{
+    // makes room for another row of bits
+    if(rows->count == rows->capacity)
+    {
+        size_t capacity = (rows->capacity) ? rows->capacity * 2 : 64;
+        uint64_t *bigger = realloc(rows->grid, capacity * rows->rowWords *
+                                               sizeof(uint64_t));
+        if(bigger == NULL)
+            return false;
+
+        rows->grid = bigger;
+        rows->capacity = capacity;
+    }
+
+    // the row must be well formed and end where the first one did
+    if(!parseLine(line, &rows->layout, rows->grid + rows->count *
+                                       rows->rowWords) ||
+       (length > rows->layout.lineLength &&
+        line[rows->layout.lineLength] != '\n'))
+        return false;
+
+    ++rows->count;
+    return true;
+}
+
+
+///
+/// Function: readFromStream
+///
+/// Description: The function used to read in a maze from a stream (stdin, or a
+///              file which can't be mapped such as a pipe). The stream is read
+///              in large blocks and every complete line is parsed as soon as it
+///              arrives, so only one block of text is ever held at once.
+///
+/// @param fileIn  The stream to read from.
+///
+/// @return the maze read in, or NULL on failure.
+///
+static Maze readFromStream(FILE * fileIn)
+{
+    // the block buffer (grown only if a single line doesn't fit)
+    size_t capacity = READ_BLOCK, filled = 0, start = 0;
+    char *buf = malloc(capacity);
+
+    // the rows parsed so far; the layout is known once the first line is in
+    struct rows_s rows = { { 0, 0, false }, NULL, 0, 0, 0 };
+    bool haveLayout = false, eof = false, blankTail = false, ok = true;
+
+    // the maze we eventually build
+    Maze maze = NULL;
 
     // READING IN FILE PROCEDURE ===============================================
 
-    // while we still have lines to read
-    while(getline(&buf, &bufsize, stdin) > 0)
-        fileStringCat(&fileString, buf);
+    while(buf != NULL && ok && !eof)
+    {
+        // makes room if a single line filled the whole buffer
+        if(filled == capacity)
+        {
+            char *bigger = realloc(buf, capacity * 2);
+            if(bigger == NULL)
+            {
+                ok = false;
+                break;
+            }
+            buf = bigger;
+            capacity *= 2;
+        }
+
+        // reads in as much as we can
+        size_t got = fread(buf + filled, 1, capacity - filled, fileIn);
+        eof = (got == 0);
+        filled += got;
+        stat_read(got);
+
+        // the first line tells us how every line is laid out
+        if(!haveLayout)
+        {
+            char *newline = memchr(buf, '\n', filled);
+
+            // we need the whole first line before we can go on
+            if(newline == NULL && !eof)
+                continue;
+
+            size_t lineLength = (newline != NULL) ? (size_t) (newline - buf)
+                                                  : filled;
+            // an empty first line means there is no maze
+            if(lineLength == 0)
+                break;
+
+            rows.layout = parseLayout(buf, lineLength);
+            rows.rowWords = (rows.layout.cols + 63) / 64;
+            haveLayout = true;
+        }
+
+        // parses every complete line we have (the last may lack a new line)
+        size_t lineLength = rows.layout.lineLength;
+        for(start = 0; ok && !blankTail; )
+        {
+            size_t left = filled - start;
+
+            // a blank line ends the maze, only blank lines may follow it
+            if(left > 0 && buf[start] == '\n')
+                blankTail = true;
+            // we need a whole line (the last may lack a new line)
+            else if(left <= lineLength && !(eof && left == lineLength))
+                break;
+            else
+            {
+                ok = appendRow(&rows, buf + start, left);
+                start += (left > lineLength) ? lineLength + 1 : left;
+            }
+        }
+
+        // anything after a blank line must be blank as well
+        for(; ok && blankTail && start < filled; ++start)
+            ok = (buf[start] == '\n');
 
-    // frees our buffer; we're done with it
+        // a partial line at the end of the stream is an error
+        if(eof && start < filled)
+            ok = false;
+
+        // moves the partial line we're left with to the front of the buffer
+        memmove(buf, buf + start, filled - start);
+        filled -= start;
+    }
+
+    // builds our maze out of the rows we read
+    if(!ok)
+        fprintf(stderr, "Malformed maze at row %zu.\n", rows.count);
+    else if(rows.count == 0)
+        printf("No maze specified.\n");
+    else
+        maze = buildMaze(rows.grid, rows.count, rows.layout.cols);
+
+    // frees our buffers; we're done with them
     free(buf);
-    buf = NULL;
+    free(rows.grid);
 
-    // return our file
-    return fileString;
+    // return our maze
+    return maze;
+}
+
+
+///
+/// Function: readStream
+///
+/// Description: Used to read a stream, which may hold a binary maze file or a
+///              text one; the first byte tells them apart.
+///
+/// @param fileIn  The stream to read from.
+///
+/// @return the maze read in, or NULL on failure.
+///
+static Maze readStream(FILE * fileIn)
+{
+    int first = getc(fileIn);
+    if(first != EOF)
+        ungetc(first, fileIn);
+
+    return (first == MAZE_FILE_MARK) ? mazeFile_read(fileIn)
+                                     : readFromStream(fileIn);
 }
 
 ///
 /// Function: readFromDisk
 ///
-/// Description: Used to read a file that exists on the disk.
+/// Description: Used to read a file that exists on the disk. The file is
+///              memory-mapped and parsed in place, so no copy of the text is
+///              ever made.
 ///
 /// @param fileIn  The file to read from.
 ///
-static char * readFromDisk(FILE * fileIn)
+/// @return the maze read in, or NULL on failure.
+///
+static Maze readFromDisk(FILE * fileIn)
 {
-    // seeks the end of the file
-    fseek(fileIn, 0, SEEK_END);
-    // tells us how long to make our buffer
-    size_t fileSize = (size_t) ftell(fileIn);
-    // jumps back to the beginning of file
-    fseek(fileIn, 0, SEEK_SET);
-
-    // allocates enough space into our buffer
-    char *fileString = malloc(fileSize + 1);
-    // reads in the file and drops it in file
-    fread(fileString, fileSize, 1, fileIn);
-
-    // returns our newly constructed char array
-    return fileString;
+    // used to find out how big the file is
+    struct stat info;
+    int fd = fileno(fileIn);
+
+    // only regular files can be mapped, anything else is read as a stream
+    if(fstat(fd, &info) != 0 || !S_ISREG(info.st_mode))
+        return readStream(fileIn);
+
+    // mmap can't map an empty file
+    if(info.st_size == 0)
+    {
+        printf("No maze specified.\n");
+        return NULL;
+    }
+
+    // a binary maze needs no parsing at all, its plane is mapped as it is
+    size_t fileSize = (size_t) info.st_size;
+    stat_read(fileSize);
+    char magic[8];
+    if(pread(fd, magic, sizeof(magic), 0) == (ssize_t) sizeof(magic) &&
+       mazeFile_isBinary(magic, sizeof(magic)))
+        return mazeFile_map(fd, fileSize);
+
+    // maps the whole file read-only
+    char *text = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // if we couldn't map it, we can still read it the slow way
+    if(text == MAP_FAILED)
+        return readStream(fileIn);
+
+    // we read through it exactly once, front to back
+    madvise(text, fileSize, MADV_SEQUENTIAL);
+
+    // parses the mapped pages directly into our maze
+    Maze maze = parseMaze(text, fileSize);
+
+    // we're done with the text
+    munmap(text, fileSize);
+
+    // returns our newly constructed maze
+    return maze;
 }
 
-/// reads in a file and returns it as a string
-char * getFileAsString(FILE * fileIn)
+/// reads in a file and returns it as a maze
+Maze getMaze(FILE * fileIn)
 {
-    // returns the file as a character array (string)
-    return (fileIn == stdin) ? readFromStdin() : readFromDisk(fileIn);
+    // returns the file parsed into a maze
+    return (fileIn == stdin) ? readStream(fileIn) : readFromDisk(fileIn);
 }
@@ -10,16 +10,24 @@
 #ifndef _FILE_READ
 #define _FILE_READ // include guard
 
+#include <stdio.h>
+#include "maze.h"
+
 ///
-/// Function: getFileAsString
+/// Function: getMaze
 ///
-/// Description: Reads in a file from the specified file and returns it as a string.
+/// Description: Reads in a maze from the specified file and parses it straight
+///              into a bit-packed Maze. Files on disk are memory-mapped and
+///              parsed in place; anything else is read in as a stream. A binary
+///              maze file is recognized by its header and loaded instead (on
+///              disk, its plane is mapped and used without a copy).
 ///
 /// @param fileIn  The file to read from.
 ///
-/// @return the file read in as a single string.
+/// @return the maze read in, or NULL if there was no maze to read or it could
+///         not be parsed (a message saying why has already been printed).
 ///
-char * getFileAsString(FILE * fileIn);
+Maze getMaze(FILE * fileIn);
 
 
 #endif
@@ -0,0 +1,255 @@
+///
+/// File: generate.c
+///
+/// Description: Generators of synthetic mazes for benchmarking.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#include <stdbool.h> // boolean items
+#include <stdlib.h> // allocation functions
+#include <string.h> // strcmp
+#include "generate.h" // generator functions and kinds
+
+// the names of the kinds, in the same order as the GenKind enum
+static const char *kindNames[] = {
+    "open", "random", "backtracker", "serpentine", "frontier"
+};
+
+
+///
+/// Function: nextRandom
+///
+/// Description: Steps a SplitMix64 generator (fast, and the same everywhere,
+///              unlike rand).
+///
+/// @param state  The state of the generator.
+///
+/// @return the next 64 random bits.
+///
+static inline uint64_t nextRandom(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+
+/// the index of the name in kindNames
+bool gen_parseKind( const char *name, GenKind *kind )
+{
+    for(size_t i = 0; i < sizeof(kindNames) / sizeof(kindNames[0]); ++i)
+        if(strcmp(name, kindNames[i]) == 0)
+        {
+            *kind = (GenKind) i;
+            return true;
+        }
+
+    return false;
+}
+
+
+/// the name in kindNames
+const char * gen_kindName( GenKind kind )
+{
+    return kindNames[kind];
+}
+
+
+///
+/// Function: fillRandom
+///
+/// Description: Makes every cell a wall with the given probability, a row at a
+///              time.
+///
+/// @param maze  The open maze to fill.
+/// @param density  The probability a cell is a wall.
+/// @param seed  The seed of the generator.
+/// @param bits  A row of packed walls to build each row in.
+///
+static void fillRandom(Maze maze, double density, uint64_t seed, uint64_t *bits)
+{
+    // a cell is a wall when its 53 random bits fall under the threshold
+    uint64_t threshold = (density >= 1.0) ? (1ULL << 53)
+                       : (density <= 0.0) ? 0
+                       : (uint64_t) (density * (double) (1ULL << 53));
+    size_t words = (maze->cols + 63) / 64;
+
+    for(size_t r = 0; r < maze->rows; ++r)
+    {
+        memset(bits, 0, words * sizeof(uint64_t));
+        for(size_t c = 0; c < maze->cols; ++c)
+            if((nextRandom(&seed) >> 11) < threshold)
+                bits[c / 64] |= (uint64_t) 1 << (c % 64);
+        maze_fillRow(maze, r, bits);
+    }
+}
+
+
+///
+/// Function: carveBacktracker
+///
+/// Description: Carves a perfect maze with a randomized depth first search.
+///              The rooms are the cells with even coordinates, and the cells
+///              between two rooms are knocked out as the search goes from one
+///              to the other. Rather than a stack, each room keeps the
+///              direction back to the room it was entered from (2 bits), so
+///              the search needs a sixteenth of a byte per cell at most.
+///
+/// @param maze  The maze to carve, all walls.
+/// @param seed  The seed of the generator.
+///
+/// @return true if the maze was carved; false if the allocation fails.
+///
+static bool carveBacktracker(Maze maze, uint64_t seed)
+{
+    size_t roomRows = (maze->rows + 1) / 2, roomCols = (maze->cols + 1) / 2;
+    uint8_t *back = calloc((roomRows * roomCols + 3) / 4, 1);
+    if(back == NULL)
+        return false;
+
+    // the row and column steps EAST, SOUTH, WEST and NORTH
+    static const int dr[4] = { 0, 1, 0, -1 }, dc[4] = { 1, 0, -1, 0 };
+
+    size_t r = 0, c = 0;
+    bit_clear(maze->walls, maze_cell(maze, 0, 0));
+
+    for(;;)
+    {
+        // the ways to a room that is still walled in
+        int ways[4], count = 0;
+        for(int d = 0; d < 4; ++d)
+        {
+            // (a step off the top or left edge wraps past the maze)
+            size_t nr = r + (size_t) (2 * dr[d]),
+                   nc = c + (size_t) (2 * dc[d]);
+            if(nr < maze->rows && nc < maze->cols && maze_isWall(maze, nr, nc))
+                ways[count++] = d;
+        }
+
+        if(count > 0)
+        {
+            // knocks through to one of them at random
+            int d = ways[nextRandom(&seed) % (uint64_t) count];
+            bit_clear(maze->walls, maze_cell(maze, r + (size_t) dr[d],
+                                             c + (size_t) dc[d]));
+            r += (size_t) (2 * dr[d]);
+            c += (size_t) (2 * dc[d]);
+            bit_clear(maze->walls, maze_cell(maze, r, c));
+
+            // remembers the way back (the opposite direction)
+            size_t room = (r / 2) * roomCols + c / 2;
+            back[room / 4] |= (uint8_t) (((d + 2) & 3) << (room % 4 * 2));
+        }
+        // nowhere new to go from here, so goes back the way it came
+        else if(r == 0 && c == 0)
+            break;
+        else
+        {
+            size_t room = (r / 2) * roomCols + c / 2;
+            int d = (back[room / 4] >> (room % 4 * 2)) & 3;
+            r += (size_t) (2 * dr[d]);
+            c += (size_t) (2 * dc[d]);
+        }
+    }
+
+    free(back);
+
+    // an exit on an odd row or column is not a room, so it is joined to the
+    // room up and to the left of it
+    size_t exitRow = maze->rows - 1, exitCol = maze->cols - 1;
+    for(size_t cc = exitCol & ~(size_t) 1; cc <= exitCol; ++cc)
+        bit_clear(maze->walls, maze_cell(maze, exitRow & ~(size_t) 1, cc));
+    for(size_t rr = exitRow & ~(size_t) 1; rr <= exitRow; ++rr)
+        bit_clear(maze->walls, maze_cell(maze, rr, exitCol));
+
+    return true;
+}
+
+
+/// builds the walls of the kind asked for into an open maze
+Maze gen_create( GenKind kind, size_t rows, size_t cols, double density,
+                 uint64_t seed )
+{
+    Maze maze = maze_create(rows, cols);
+    if(maze == NULL)
+        return NULL;
+
+    // a row of packed walls to build each row in
+    size_t words = (cols + 63) / 64;
+    uint64_t *bits = calloc(words, sizeof(uint64_t));
+    if(bits == NULL)
+    {
+        maze_destroy(maze);
+        return NULL;
+    }
+
+    bool ok = true;
+    switch(kind)
+    {
+        case GEN_RANDOM:
+            fillRandom(maze, density, seed, bits);
+            break;
+        case GEN_BACKTRACKER:
+            // starts as all walls (bits past the last column stay clear)
+            memset(bits, 0xff, words * sizeof(uint64_t));
+            if(cols % 64)
+                bits[words - 1] = ((uint64_t) 1 << (cols % 64)) - 1;
+            for(size_t r = 0; r < rows; ++r)
+                maze_fillRow(maze, r, bits);
+            ok = carveBacktracker(maze, seed);
+            break;
+        case GEN_SERPENTINE:
+            // every odd row is a wall with a gap at alternating ends
+            for(size_t r = 1; r < rows; r += 2)
+                for(size_t c = 0; c < cols; ++c)
+                    if(c != ((r / 2) % 2 == 0 ? cols - 1 : 0))
+                        maze_setWall(maze, r, c);
+            break;
+        case GEN_FRONTIER:
+            for(size_t r = 1; r < rows; r += 2)
+                for(size_t c = 1; c < cols; c += 2)
+                    maze_setWall(maze, r, c);
+            break;
+        case GEN_OPEN:
+        default:
+            break;
+    }
+
+    free(bits);
+    if(!ok)
+    {
+        maze_destroy(maze);
+        return NULL;
+    }
+
+    // the ends are always open
+    bit_clear(maze->walls, maze_cell(maze, 0, 0));
+    bit_clear(maze->walls, maze_cell(maze, rows - 1, cols - 1));
+
+    return maze;
+}
+
+
+/// builds each row as text and writes it in one go
+bool gen_write( Maze maze, FILE *out )
+{
+    char *line = malloc(2 * maze->cols);
+    if(line == NULL)
+        return false;
+
+    for(size_t r = 0; r < maze->rows; ++r)
+    {
+        for(size_t c = 0; c < maze->cols; ++c)
+        {
+            line[2 * c] = maze_isWall(maze, r, c) ? '1' : '0';
+            line[2 * c + 1] = (c + 1 < maze->cols) ? ' ' : '\n';
+        }
+        fwrite(line, 1, 2 * maze->cols, out);
+    }
+
+    free(line);
+    return !ferror(out);
+}
@@ -0,0 +1,86 @@
+///
+/// File: generate.h
+///
+/// Description: Interface to the maze generators, which build synthetic mazes
+///              of any size for benchmarking. Every generator is deterministic:
+///              the same kind, size, density and seed always give the same
+///              maze, on any machine.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#ifndef _GENERATE_H_
+#define _GENERATE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "maze.h"
+
+// the kinds of maze that can be generated
+typedef enum genKind_e{
+    // no walls at all
+    GEN_OPEN,
+    // every cell a wall with the given probability (the ends stay open)
+    GEN_RANDOM,
+    // a perfect maze (one path between any two rooms) carved by a randomized
+    // depth first search
+    GEN_BACKTRACKER,
+    // one corridor winding back and forth across the whole maze
+    GEN_SERPENTINE,
+    // a lattice of single-cell pillars; every level of a BFS spans the maze
+    // and every cell can be reached from two others at once
+    GEN_FRONTIER
+} GenKind;
+
+///
+/// Turns the name of a kind of maze ("open", "random", "backtracker",
+/// "serpentine" or "frontier") into a GenKind.
+///
+/// @param name  the name of the kind.
+/// @param kind  where the kind is stored if the name is known.
+///
+/// @return true if the name is a known kind, false otherwise.
+///
+bool gen_parseKind( const char *name, GenKind *kind );
+
+///
+/// Gets the name of a kind of maze.
+///
+/// @param kind  the kind to name.
+///
+/// @return the name gen_parseKind takes for it.
+///
+const char * gen_kindName( GenKind kind );
+
+///
+/// Generates a maze. The entrance (0, 0) and exit (rows - 1, cols - 1) are
+/// always open.
+///
+/// @param kind  the kind of maze to generate.
+/// @param rows  the number of rows in the maze.
+/// @param cols  the number of columns in the maze.
+/// @param density  the probability a cell is a wall (GEN_RANDOM only).
+/// @param seed  the seed of the random choices (GEN_RANDOM and
+///              GEN_BACKTRACKER only).
+///
+/// @return a Maze instance, or NULL if the maze is empty or too large to
+///         index with 32 bits, or the allocation fails.
+///
+Maze gen_create( GenKind kind, size_t rows, size_t cols, double density,
+                 uint64_t seed );
+
+///
+/// Writes a maze out in the text format getMaze reads (rows of space
+/// separated 1s for walls and 0s for open cells).
+///
+/// @param maze  the maze to write.
+/// @param out  the stream to write it to.
+///
+/// @return true if it was all written; false otherwise.
+///
+bool gen_write( Maze maze, FILE *out );
+
+#endif
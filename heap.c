@@ -0,0 +1,159 @@
+///
+/// File: heap.c
+///
+/// Description: An abstract data type for a binary min-heap.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#include <stdio.h> // error reporting
+#include <stdlib.h> // malloc, free
+#include <stdbool.h> // boolean data members
+#include <assert.h> // used for the assert in heap_remove(1)
+#include "heap.h" // heap functions and structures
+
+
+// the smallest array of entries we will ever allocate
+#define HEAP_MIN_CAPACITY 64
+
+
+/// creates an empty heap able to hold capacity entries before growing
+Heap heap_create( size_t capacity )
+{
+    // pointer to a new heap (set to NULL for now)
+    Heap heap = NULL;
+    // allocates enough space for our heap
+    heap = malloc(sizeof(struct heap_s));
+
+    // if we encounter an error in creating our heap
+    if(heap == NULL)
+        return heap;
+
+    // allocates the entries up front so inserts rarely allocate
+    heap->capacity = (capacity > HEAP_MIN_CAPACITY) ? capacity
+                                                    : HEAP_MIN_CAPACITY;
+    heap->nodes = malloc(heap->capacity * sizeof(HNode));
+
+    // if we could not get the array we cannot have a heap either
+    if(heap->nodes == NULL)
+    {
+        free(heap);
+        return NULL;
+    }
+
+    // current size is 0
+    heap->size = 0;
+
+    // returns our new, empty heap
+    return heap;
+}
+
+
+/// clears a heap of all data; the array is kept for reuse
+void heap_clear( Heap heap )
+{
+    if(heap != NULL)
+        heap->size = 0;
+}
+
+
+/// destroys the heap, freeing it from memory
+void heap_destroy( Heap heap )
+{
+    // nothing to do for a heap that was never made
+    if(heap == NULL)
+        return;
+
+    free(heap->nodes);
+    free(heap);
+}
+
+
+/// inserts an entry, sifting it up past any parent with a larger key
+void heap_insert( Heap heap, uint64_t key, uint64_t value )
+{
+    // makes room if the array is full
+    if(heap->size == heap->capacity)
+    {
+        HNode *nodes = realloc(heap->nodes,
+                               heap->capacity * 2 * sizeof(HNode));
+
+        // we cannot continue the search without space for the entry
+        if(nodes == NULL)
+        {
+            fprintf(stderr, "Unable to grow heap to %zu entries.\n",
+                    heap->capacity * 2);
+            exit(EXIT_FAILURE);
+        }
+
+        heap->nodes = nodes;
+        heap->capacity *= 2;
+    }
+
+    // starts at the bottom and moves parents down until the entry fits
+    size_t index = heap->size++;
+    while(index > 0)
+    {
+        size_t parent = (index - 1) / 2;
+        if(heap->nodes[parent].key <= key)
+            break;
+
+        heap->nodes[index] = heap->nodes[parent];
+        index = parent;
+    }
+
+    heap->nodes[index].key = key;
+    heap->nodes[index].value = value;
+}
+
+
+/// removes the smallest entry, sifting the last entry down into its place
+HNode heap_remove( Heap heap )
+{
+    // we can't remove from an empty heap
+    assert(!heap_empty(heap));
+
+    HNode top = heap->nodes[0];
+    HNode last = heap->nodes[--heap->size];
+
+    // starts at the top and moves smaller children up until last fits
+    size_t index = 0;
+    for(;;)
+    {
+        size_t child = index * 2 + 1;
+        if(child >= heap->size)
+            break;
+
+        // picks the smaller of the two children
+        if(child + 1 < heap->size &&
+           heap->nodes[child + 1].key < heap->nodes[child].key)
+            ++child;
+
+        if(last.key <= heap->nodes[child].key)
+            break;
+
+        heap->nodes[index] = heap->nodes[child];
+        index = child;
+    }
+
+    if(heap->size > 0)
+        heap->nodes[index] = last;
+
+    // returns the entry we just removed
+    return top;
+}
+
+
+/// returns if the heap is empty or not
+bool heap_empty( Heap heap )
+{
+    return (heap->size == 0) ? true : false;
+}
+
+
+/// returns the number of entries in the heap
+size_t heap_size( Heap heap )
+{
+    return heap->size;
+}
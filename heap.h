@@ -0,0 +1,98 @@
+///
+/// File: heap.h
+///
+/// Description:  Interface to the Heap module, a binary min-heap used as the
+///               priority queue of the best-first searches.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#ifndef _HEAP_H_
+#define _HEAP_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// our storage unit
+typedef struct hnode_s{
+    // the priority of the entry (smallest comes out first)
+    uint64_t key;
+    // whatever the caller wants to keep with the entry
+    uint64_t value;
+} HNode;
+
+// Heap structure
+// NOTE: the entries are stored by value in one growable array, so an insert
+//       only allocates on the rare occasion the array has to grow
+typedef struct heap_s{
+    // the array of entries, laid out as an implicit binary tree
+    HNode *nodes;
+    // the number of entries there is room for
+    size_t capacity;
+    // the size of our heap
+    size_t size;
+} * Heap;
+
+///
+/// Create a Heap routine.
+///
+/// @param capacity  the expected number of entries the heap will hold at once.
+///
+/// @return a Heap instance, or NULL if the allocation fails.
+///
+Heap heap_create( size_t capacity );
+
+///
+/// Tear down and deallocate the supplied Heap.
+///
+/// @param heap - the Heap to be manipulated.
+///
+void heap_destroy( Heap heap );
+
+///
+/// Remove all contents from the supplied Heap.
+///
+/// @param heap - the Heap to be manipulated.
+///
+void heap_clear( Heap heap );
+
+///
+/// Insert an entry into the Heap.
+///
+/// @param heap the Heap into which the entry is to be inserted.
+/// @param key  the priority of the entry.
+/// @param value  the value kept with the entry.
+/// @exception If the heap is full and cannot be grown, the program
+///     terminates with an error message printed to the standard error
+///     output and an exit status of EXIT_FAILURE.
+///
+void heap_insert( Heap heap, uint64_t key, uint64_t value );
+
+///
+/// Remove and return the entry with the smallest key from the Heap.
+///
+/// @param heap the Heap to be manipulated.
+/// @return the entry that was removed from the heap.
+/// @exception If the heap is empty, an assert() fails.
+///
+HNode heap_remove( Heap heap );
+
+///
+/// Indicate whether or not the supplied Heap is empty.
+///
+/// @param the Heap to be tested.
+/// @return true if the heap is empty, otherwise false.
+///
+bool heap_empty( Heap heap );
+
+///
+/// Get the number of entries currently held in the Heap.
+///
+/// @param the Heap to be measured.
+/// @return the number of entries in the heap.
+///
+size_t heap_size( Heap heap );
+
+#endif
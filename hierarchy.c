@@ -0,0 +1,1075 @@
+///
+/// File: hierarchy.c
+///
+/// Description: The abstract graph of a maze's clusters and their entrances,
+///              the queries answered through it, and the binary file it is
+///              cached in. A cache file is a small header (which says what
+///              maze the graph is for and how it was built) followed by the
+///              graph's arrays exactly as they are held in memory, so loading
+///              one is just mapping it.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#include <pthread.h> // threads
+#include <stdio.h> // error reporting, file writing, rename
+#include <stdlib.h> // allocation functions, qsort
+#include <string.h> // memcmp, memcpy, memset
+#include <fcntl.h> // open
+#include <unistd.h> // close
+#include <sys/mman.h> // mmap
+#include <sys/stat.h> // fstat
+#include "hierarchy.h" // hierarchy functions and structures
+#include "heap.h" // heap related items
+#include "stats.h" // instrumentation counters
+
+
+// a run of facing cells at least this long gets an entrance at each end
+#define LONG_RUN 6
+
+// the distance to a node that hasn't been reached
+#define UNREACHED UINT32_MAX
+
+// the first bytes of every cache file (the last byte is the format version)
+static const char hierMagic[8] = { 'M', 'O', 'P', 'H', 'I', 'E', 'R', 1 };
+
+// the header at the front of a cache file
+struct hierHeader_s{
+    char magic[8];
+    // the maze_hash of the maze the graph is for
+    uint64_t hash;
+    // the size of that maze
+    uint64_t rows, cols;
+    // how the graph was built
+    uint64_t side, exact;
+    // the size of the graph's arrays
+    uint64_t clusters, nodes, links, tableEntries;
+};
+
+// two entrances facing each other across the edge of two clusters
+struct crossing_s{
+    uint32_t from, to;
+};
+
+// the crossings found so far while building
+struct crossings_s{
+    struct crossing_s *list;
+    size_t count, capacity;
+};
+
+// the state shared by the threads building the tables
+struct tableWork_s{
+    // the graph being built, and the maze it is for
+    Hierarchy hier;
+    Maze maze;
+    // the next cluster to be claimed
+    size_t cursor;
+    // cleared by a thread that couldn't get its working space
+    bool ok;
+};
+
+// the working space of a query
+struct hierScratch_s{
+    // the best distance found to every node, and the query that found it
+    uint32_t *best, *stamps;
+    // the stamp of the current query
+    uint32_t epoch;
+    // the nodes waiting to be expanded, by distance
+    Heap open;
+    // the goal, the distance from it to every node of its cluster and the
+    // regions those nodes are in
+    size_t goalRow, goalCol;
+    uint32_t *toGoal, *goalRegions;
+    // the copy of a cluster, and the distances and queue of a search in it
+    uint8_t *grid;
+    uint16_t *local;
+    uint32_t *queue;
+};
+
+
+///
+/// Function: clusterOf
+///
+/// Description: Gets the cluster a cell is in.
+///
+static inline size_t clusterOf(Hierarchy hier, Maze maze, uint32_t cell)
+{
+    return (maze_row(maze, cell) / hier->side) * hier->clusterCols +
+           maze_col(maze, cell) / hier->side;
+}
+
+
+///
+/// Function: localIndex
+///
+/// Description: Gets where a cell is kept in the padded copy of its cluster
+///              (see loadCluster).
+///
+static inline size_t localIndex(Hierarchy hier, Maze maze, uint32_t cell)
+{
+    return (maze_row(maze, cell) % hier->side + 1) * (hier->side + 2) +
+           maze_col(maze, cell) % hier->side + 1;
+}
+
+
+///
+/// Function: loadCluster
+///
+/// Description: Copies which cells of a cluster are open into a grid of its
+///              own, one byte per cell, with a closed border around it (just
+///              as a maze has), so a search inside the cluster never needs a
+///              bounds check.
+///
+/// @param hier  The graph the cluster is part of.
+/// @param maze  The maze the graph is for.
+/// @param cluster  The cluster to copy.
+/// @param *open  Filled in with the copy, (side + 2) * (side + 2) bytes.
+///
+static void loadCluster(Hierarchy hier, Maze maze, size_t cluster,
+                        uint8_t *open)
+{
+    size_t side = hier->side, width = side + 2;
+    size_t firstRow = (cluster / hier->clusterCols) * side,
+           firstCol = (cluster % hier->clusterCols) * side;
+
+    // a cluster on the bottom or east edge may be cut short
+    size_t rows = (maze->rows - firstRow < side) ? maze->rows - firstRow
+                                                 : side;
+    size_t cols = (maze->cols - firstCol < side) ? maze->cols - firstCol
+                                                 : side;
+
+    memset(open, 0, width * width);
+    for(size_t r = 0; r < rows; ++r)
+        for(size_t c = 0; c < cols; ++c)
+            open[(r + 1) * width + c + 1] =
+                !maze_isWall(maze, firstRow + r, firstCol + c);
+}
+
+
+///
+/// Function: clusterSearch
+///
+/// Description: Runs a BFS inside a cluster copied by loadCluster.
+///
+/// @param width  The width of the copy (the side of a cluster + 2).
+/// @param *open  The copy of the cluster.
+/// @param from  Where the cell to search from is in the copy (open).
+/// @param *steps  Filled in with the number of steps to every cell of the
+///                copy (UINT16_MAX if it can't be reached).
+/// @param *queue  Room for the queue, one entry per cell of the cluster.
+///
+static void clusterSearch(size_t width, const uint8_t *open, size_t from,
+                          uint16_t *steps, uint32_t *queue)
+{
+    memset(steps, 0xff, width * width * sizeof(uint16_t));
+
+    size_t head = 0, tail = 0;
+    queue[tail++] = (uint32_t) from;
+    steps[from] = 0;
+
+    while(head < tail)
+    {
+        uint32_t cell = queue[head++];
+        uint16_t next = steps[cell] + 1;
+
+        // the border of the copy is closed, so the neighbors always exist
+        uint32_t neighbors[4] = {
+            cell + 1,
+            cell + (uint32_t) width,
+            cell - 1,
+            cell - (uint32_t) width
+        };
+
+        for(int i = 0; i < 4; ++i)
+            if(open[neighbors[i]] && steps[neighbors[i]] == UINT16_MAX)
+            {
+                steps[neighbors[i]] = next;
+                queue[tail++] = neighbors[i];
+            }
+    }
+}
+
+
+///
+/// Function: addCrossing
+///
+/// Description: Records a pair of entrances facing each other.
+///
+/// @return true if it was recorded; false if the allocation fails.
+///
+static bool addCrossing(struct crossings_s *crossings, uint32_t from,
+                        uint32_t to)
+{
+    if(crossings->count == crossings->capacity)
+    {
+        size_t capacity = crossings->capacity ? 2 * crossings->capacity : 1024;
+        struct crossing_s *list = realloc(crossings->list,
+                                          capacity * sizeof(*list));
+        if(list == NULL)
+            return false;
+        crossings->list = list;
+        crossings->capacity = capacity;
+    }
+
+    crossings->list[crossings->count].from = from;
+    crossings->list[crossings->count].to = to;
+    ++crossings->count;
+
+    return true;
+}
+
+
+///
+/// Function: scanEdge
+///
+/// Description: Finds the entrances along one line between two rows (or two
+///              columns) of clusters. The line is walked cell by cell, and
+///              every run of facing open cells (broken at the corners of the
+///              clusters) gets its entrances.
+///
+/// @param hier  The graph being built.
+/// @param maze  The maze it is for.
+/// @param *crossings  Where the entrances are recorded.
+/// @param across  true if the line runs between rows at - 1 and at; false if
+///                it runs between columns at - 1 and at.
+/// @param at  The first row (or column) after the line.
+///
+/// @return true if the entrances were recorded; false if the allocation
+///         fails.
+///
+static bool scanEdge(Hierarchy hier, Maze maze, struct crossings_s *crossings,
+                     bool across, size_t at)
+{
+    size_t length = across ? maze->cols : maze->rows;
+    size_t runStart = 0, runLength = 0;
+
+    for(size_t p = 0; p <= length; ++p)
+    {
+        uint32_t before = 0, after = 0;
+        bool open = false;
+        if(p < length)
+        {
+            before = across ? maze_cell(maze, at - 1, p)
+                            : maze_cell(maze, p, at - 1);
+            after = across ? maze_cell(maze, at, p) : maze_cell(maze, p, at);
+            open = !bit_test(maze->walls, before) &&
+                   !bit_test(maze->walls, after);
+        }
+
+        // a run ends at a wall or at the corner of a cluster
+        if(runLength > 0 && (!open || p % hier->side == 0))
+        {
+            for(size_t q = runStart; q < runStart + runLength; ++q)
+            {
+                // every cell of an exact graph; the middle or the two ends
+                // of a run otherwise
+                bool entrance = hier->exact ||
+                    (runLength < LONG_RUN && q == runStart + runLength / 2) ||
+                    (runLength >= LONG_RUN &&
+                     (q == runStart || q == runStart + runLength - 1));
+
+                if(entrance &&
+                   !addCrossing(crossings,
+                                across ? maze_cell(maze, at - 1, q)
+                                       : maze_cell(maze, q, at - 1),
+                                across ? maze_cell(maze, at, q)
+                                       : maze_cell(maze, q, at)))
+                    return false;
+            }
+            runLength = 0;
+        }
+
+        if(open)
+        {
+            if(runLength == 0)
+                runStart = p;
+            ++runLength;
+        }
+    }
+
+    return true;
+}
+
+
+///
+/// Function: compareKeys
+///
+/// Description: Orders 64-bit keys, for qsort.
+///
+static int compareKeys(const void *a, const void *b)
+{
+    uint64_t left = *(const uint64_t *) a, right = *(const uint64_t *) b;
+
+    return (left < right) ? -1 : (left > right);
+}
+
+
+///
+/// Function: findNode
+///
+/// Description: Finds the node a cell is.
+///
+/// @return the node (the cell must be one).
+///
+static uint32_t findNode(Hierarchy hier, Maze maze, uint32_t cell)
+{
+    size_t cluster = clusterOf(hier, maze, cell);
+    uint32_t low = hier->clusterFirst[cluster],
+             high = hier->clusterFirst[cluster + 1];
+
+    while(low < high)
+    {
+        uint32_t middle = low + (high - low) / 2;
+        if(hier->nodeCell[middle] < cell)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return low;
+}
+
+
+///
+/// Function: buildNodes
+///
+/// Description: Makes the nodes of the graph out of the entrances, sorted by
+///              cluster and then by cell (a cell on the corner of a cluster
+///              may be an entrance twice, but is one node), and links them.
+///
+/// @return true if the nodes were made; false if the allocation fails.
+///
+static bool buildNodes(Hierarchy hier, Maze maze,
+                       const struct crossings_s *crossings)
+{
+    // every entrance keyed by cluster, then cell
+    size_t count = 2 * crossings->count;
+    uint64_t *keys = malloc((count ? count : 1) * sizeof(uint64_t));
+    if(keys == NULL)
+        return false;
+
+    for(size_t i = 0; i < crossings->count; ++i)
+    {
+        uint32_t from = crossings->list[i].from, to = crossings->list[i].to;
+        keys[2 * i] = ((uint64_t) clusterOf(hier, maze, from) << 32) | from;
+        keys[2 * i + 1] = ((uint64_t) clusterOf(hier, maze, to) << 32) | to;
+    }
+    qsort(keys, count, sizeof(uint64_t), compareKeys);
+
+    // drops the repeats
+    size_t nodes = 0;
+    for(size_t i = 0; i < count; ++i)
+        if(i == 0 || keys[i] != keys[i - 1])
+            keys[nodes++] = keys[i];
+
+    hier->nodes = nodes;
+    hier->links = count;
+    hier->clusterFirst = calloc(hier->clusters + 1, sizeof(uint32_t));
+    hier->nodeCell = malloc((nodes ? nodes : 1) * sizeof(uint32_t));
+    hier->linkFirst = calloc(nodes + 1, sizeof(uint32_t));
+    hier->linkTo = malloc((count ? count : 1) * sizeof(uint32_t));
+    if(hier->clusterFirst == NULL || hier->nodeCell == NULL ||
+       hier->linkFirst == NULL || hier->linkTo == NULL)
+    {
+        free(keys);
+        return false;
+    }
+
+    // the nodes, and where each cluster's start
+    for(size_t i = 0; i < nodes; ++i)
+    {
+        hier->nodeCell[i] = (uint32_t) keys[i];
+        ++hier->clusterFirst[(keys[i] >> 32) + 1];
+    }
+    for(size_t c = 0; c < hier->clusters; ++c)
+        hier->clusterFirst[c + 1] += hier->clusterFirst[c];
+    free(keys);
+
+    // counts the links of every node, then fills them in
+    for(size_t i = 0; i < crossings->count; ++i)
+    {
+        ++hier->linkFirst[findNode(hier, maze, crossings->list[i].from) + 1];
+        ++hier->linkFirst[findNode(hier, maze, crossings->list[i].to) + 1];
+    }
+    for(size_t n = 0; n < nodes; ++n)
+        hier->linkFirst[n + 1] += hier->linkFirst[n];
+
+    uint32_t *filled = calloc(nodes ? nodes : 1, sizeof(uint32_t));
+    if(filled == NULL)
+        return false;
+    for(size_t i = 0; i < crossings->count; ++i)
+    {
+        uint32_t from = findNode(hier, maze, crossings->list[i].from),
+                 to = findNode(hier, maze, crossings->list[i].to);
+        hier->linkTo[hier->linkFirst[from] + filled[from]++] = to;
+        hier->linkTo[hier->linkFirst[to] + filled[to]++] = from;
+    }
+    free(filled);
+
+    return true;
+}
+
+
+///
+/// Function: measureClusters
+///
+/// Description: The loop every thread building the tables runs: claims a
+///              cluster at a time and fills in its table with a search inside
+///              it from each of its nodes.
+///
+/// @param *arg  The tableWork_s shared by the threads.
+///
+/// @return NULL
+///
+static void * measureClusters(void *arg)
+{
+    struct tableWork_s *work = arg;
+    Hierarchy hier = work->hier;
+    Maze maze = work->maze;
+
+    // this thread's copy of a cluster and the working space of its searches
+    size_t width = hier->side + 2;
+    uint8_t *grid = malloc(width * width);
+    uint16_t *local = malloc(width * width * sizeof(uint16_t));
+    uint32_t *queue = malloc(hier->side * hier->side * sizeof(uint32_t));
+    if(grid == NULL || local == NULL || queue == NULL)
+        __atomic_store_n(&work->ok, false, __ATOMIC_RELAXED);
+
+    size_t c;
+    while(grid != NULL && local != NULL && queue != NULL &&
+          (c = __atomic_fetch_add(&work->cursor, 1, __ATOMIC_RELAXED))
+          < hier->clusters)
+    {
+        uint32_t first = hier->clusterFirst[c], last = hier->clusterFirst[c + 1];
+        uint16_t *table = hier->tables + hier->tableFirst[c];
+
+        // a cluster with no way in or out needs no table
+        if(first == last)
+            continue;
+
+        loadCluster(hier, maze, c, grid);
+        for(uint32_t from = first; from < last; ++from)
+        {
+            clusterSearch(width, grid,
+                          localIndex(hier, maze, hier->nodeCell[from]),
+                          local, queue);
+            for(uint32_t to = first; to < last; ++to)
+                *table++ = local[localIndex(hier, maze, hier->nodeCell[to])];
+        }
+    }
+
+    free(grid);
+    free(local);
+    free(queue);
+
+    return NULL;
+}
+
+
+///
+/// Function: buildTables
+///
+/// Description: Lays out the table of every cluster, then has a pool of
+///              threads fill them in (the clusters don't depend on each
+///              other, so they are simply shared out).
+///
+/// @param hier  The graph being built.
+/// @param maze  The maze it is for.
+/// @param threads  The number of threads to measure with (at least 1).
+///
+/// @return true if the tables were made; false if the allocation fails.
+///
+static bool buildTables(Hierarchy hier, Maze maze, unsigned threads)
+{
+    hier->tableFirst = malloc((hier->clusters + 1) * sizeof(uint64_t));
+    if(hier->tableFirst == NULL)
+        return false;
+
+    hier->tableFirst[0] = 0;
+    for(size_t c = 0; c < hier->clusters; ++c)
+    {
+        uint64_t size = hier->clusterFirst[c + 1] - hier->clusterFirst[c];
+        hier->tableFirst[c + 1] = hier->tableFirst[c] + size * size;
+    }
+
+    uint64_t entries = hier->tableFirst[hier->clusters];
+    hier->tables = malloc((entries ? entries : 1) * sizeof(uint16_t));
+    if(hier->tables == NULL)
+        return false;
+
+    struct tableWork_s work = { hier, maze, 0, true };
+
+    // the calling thread is one of the pool; if a thread can't be started
+    // the others just measure more clusters each
+    pthread_t *pool = calloc(threads, sizeof(pthread_t));
+    unsigned started = 1;
+    while(pool != NULL && started < threads &&
+          pthread_create(&pool[started], NULL, measureClusters, &work) == 0)
+        ++started;
+
+    measureClusters(&work);
+    for(unsigned t = 1; t < started; ++t)
+        pthread_join(pool[t], NULL);
+    free(pool);
+
+    return work.ok;
+}
+
+
+///
+/// Function: findRoot
+///
+/// Description: Finds the root of a node's set in a union-find, halving the
+///              path to it on the way.
+///
+static uint32_t findRoot(uint32_t *parent, uint32_t node)
+{
+    while(parent[node] != node)
+    {
+        parent[node] = parent[parent[node]];
+        node = parent[node];
+    }
+
+    return node;
+}
+
+
+///
+/// Function: buildRegions
+///
+/// Description: Labels every node with the connected region of the graph it
+///              is in, joining the nodes of each link and of each path inside
+///              a cluster with a union-find.
+///
+/// @return true if the labels were made; false if the allocation fails.
+///
+static bool buildRegions(Hierarchy hier)
+{
+    size_t nodes = hier->nodes ? hier->nodes : 1;
+    hier->nodeRegion = malloc(nodes * sizeof(uint32_t));
+    if(hier->nodeRegion == NULL)
+        return false;
+
+    uint32_t *parent = hier->nodeRegion;
+    for(uint32_t n = 0; n < hier->nodes; ++n)
+        parent[n] = n;
+
+    for(size_t c = 0; c < hier->clusters; ++c)
+    {
+        uint32_t first = hier->clusterFirst[c], last = hier->clusterFirst[c + 1];
+        const uint16_t *table = hier->tables + hier->tableFirst[c];
+
+        for(uint32_t from = first; from < last; ++from)
+            for(uint32_t to = from + 1; to < last; ++to)
+                if(table[(uint64_t) (from - first) * (last - first) +
+                         (to - first)] != UINT16_MAX)
+                    parent[findRoot(parent, from)] = findRoot(parent, to);
+    }
+
+    for(uint32_t n = 0; n < hier->nodes; ++n)
+        for(uint32_t l = hier->linkFirst[n]; l < hier->linkFirst[n + 1]; ++l)
+            parent[findRoot(parent, n)] = findRoot(parent, hier->linkTo[l]);
+
+    // every node is labeled with its root
+    for(uint32_t n = 0; n < hier->nodes; ++n)
+        parent[n] = findRoot(parent, n);
+
+    return true;
+}
+
+
+/// finds the entrances of every cluster, then links and measures them
+Hierarchy hier_create( Maze maze, size_t side, bool exact,
+                       unsigned threads )
+{
+    if(side < 1 || side > HIER_MAX_SIDE)
+        return NULL;
+
+    Hierarchy hier = calloc(1, sizeof(struct hierarchy_s));
+    if(hier == NULL)
+        return NULL;
+
+    hier->rows = maze->rows;
+    hier->cols = maze->cols;
+    hier->hash = maze_hash(maze);
+    hier->side = side;
+    hier->exact = exact;
+    hier->clusterRows = (maze->rows + side - 1) / side;
+    hier->clusterCols = (maze->cols + side - 1) / side;
+    hier->clusters = hier->clusterRows * hier->clusterCols;
+
+    // the entrances on every line between two rows, then two columns, of
+    // clusters
+    struct crossings_s crossings = { NULL, 0, 0 };
+    bool ok = true;
+    for(size_t at = side; ok && at < maze->rows; at += side)
+        ok = scanEdge(hier, maze, &crossings, true, at);
+    for(size_t at = side; ok && at < maze->cols; at += side)
+        ok = scanEdge(hier, maze, &crossings, false, at);
+
+    ok = ok && buildNodes(hier, maze, &crossings) &&
+         buildTables(hier, maze, threads) && buildRegions(hier);
+    free(crossings.list);
+
+    if(!ok)
+    {
+        hier_destroy(hier);
+        return NULL;
+    }
+
+    return hier;
+}
+
+
+///
+/// Function: checkGraph
+///
+/// Description: Checks that a graph read from a cache file holds together
+///              (every first-of array runs in order from 0 to the end of the
+///              array it indexes, every node is a cell of its own cluster
+///              and every link and region is a node), so a corrupted file
+///              can't send a query outside the graph.
+///
+/// @param hier  The graph, with its arrays in place.
+/// @param maze  The maze the graph is for.
+/// @param entries  The number of table entries the file says it has.
+///
+/// @return true if the graph can be used; false otherwise.
+///
+static bool checkGraph(Hierarchy hier, Maze maze, uint64_t entries)
+{
+    if(hier->clusterFirst[0] != 0 || hier->tableFirst[0] != 0 ||
+       hier->clusterFirst[hier->clusters] != hier->nodes ||
+       hier->tableFirst[hier->clusters] != entries ||
+       hier->linkFirst[0] != 0 || hier->linkFirst[hier->nodes] != hier->links)
+        return false;
+
+    for(size_t c = 0; c < hier->clusters; ++c)
+    {
+        uint32_t first = hier->clusterFirst[c],
+                 last = hier->clusterFirst[c + 1];
+        uint64_t size = (uint64_t) last - first;
+        if(last < first ||
+           hier->tableFirst[c + 1] - hier->tableFirst[c] != size * size)
+            return false;
+
+        for(uint32_t n = first; n < last; ++n)
+        {
+            uint32_t cell = hier->nodeCell[n];
+            if(maze_row(maze, cell) >= maze->rows ||
+               maze_col(maze, cell) >= maze->cols ||
+               clusterOf(hier, maze, cell) != c ||
+               (n > first && cell <= hier->nodeCell[n - 1]) ||
+               hier->nodeRegion[n] >= hier->nodes)
+                return false;
+        }
+    }
+
+    for(size_t n = 0; n < hier->nodes; ++n)
+        if(hier->linkFirst[n + 1] < hier->linkFirst[n])
+            return false;
+    for(size_t l = 0; l < hier->links; ++l)
+        if(hier->linkTo[l] >= hier->nodes)
+            return false;
+
+    return true;
+}
+
+
+/// maps a cache file, if it holds the graph asked for
+Hierarchy hier_load( const char *path, Maze maze, size_t side, bool exact )
+{
+    if(side < 1 || side > HIER_MAX_SIDE)
+        return NULL;
+
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+        return NULL;
+
+    struct stat info;
+    if(fstat(fd, &info) != 0 ||
+       (size_t) info.st_size < sizeof(struct hierHeader_s))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    size_t length = (size_t) info.st_size;
+    void *mapping = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(mapping == MAP_FAILED)
+        return NULL;
+
+    // the header has to match this maze and the way it is to be built, and
+    // the file has to be exactly as long as it says (added up so that a
+    // corrupted count can't wrap around to the right length)
+    const struct hierHeader_s *header = mapping;
+    size_t clusters = header->clusters, nodes = header->nodes;
+    size_t clusterRows = (maze->rows + side - 1) / side,
+           clusterCols = (maze->cols + side - 1) / side;
+    size_t words = 0, expected = 0;
+    bool sized = clusters == clusterRows * clusterCols &&
+        nodes < UINT32_MAX && header->links < UINT32_MAX &&
+        header->tableEntries <= SIZE_MAX / sizeof(uint16_t) &&
+        !__builtin_add_overflow(3 * (clusters + 1) + 3 * nodes + 1,
+                                header->links, &words) &&
+        !__builtin_mul_overflow(words, sizeof(uint32_t), &expected) &&
+        !__builtin_add_overflow(expected, sizeof(struct hierHeader_s),
+                                &expected) &&
+        !__builtin_add_overflow(expected,
+                                header->tableEntries * sizeof(uint16_t),
+                                &expected);
+    if(memcmp(header->magic, hierMagic, sizeof(hierMagic)) != 0 ||
+       header->rows != maze->rows || header->cols != maze->cols ||
+       header->side != side || header->exact != exact || !sized ||
+       length != expected || header->hash != maze_hash(maze))
+    {
+        munmap(mapping, length);
+        return NULL;
+    }
+
+    Hierarchy hier = calloc(1, sizeof(struct hierarchy_s));
+    if(hier == NULL)
+    {
+        munmap(mapping, length);
+        return NULL;
+    }
+
+    hier->rows = maze->rows;
+    hier->cols = maze->cols;
+    hier->hash = header->hash;
+    hier->side = side;
+    hier->exact = exact;
+    hier->clusterRows = (maze->rows + side - 1) / side;
+    hier->clusterCols = (maze->cols + side - 1) / side;
+    hier->clusters = clusters;
+    hier->nodes = nodes;
+    hier->links = header->links;
+
+    // the arrays follow the header, widest first so each is aligned
+    hier->tableFirst = (uint64_t *) (header + 1);
+    hier->clusterFirst = (uint32_t *) (hier->tableFirst + clusters + 1);
+    hier->nodeCell = hier->clusterFirst + clusters + 1;
+    hier->linkFirst = hier->nodeCell + nodes;
+    hier->linkTo = hier->linkFirst + nodes + 1;
+    hier->nodeRegion = hier->linkTo + hier->links;
+    hier->tables = (uint16_t *) (hier->nodeRegion + nodes);
+    hier->mapping = mapping;
+    hier->mappingLength = length;
+
+    if(!checkGraph(hier, maze, header->tableEntries))
+    {
+        hier_destroy(hier);
+        return NULL;
+    }
+
+    return hier;
+}
+
+
+/// writes a cache file beside path, then renames it into place
+bool hier_save( Hierarchy hier, const char *path )
+{
+    // the file we write to before it is finished
+    size_t pathLength = strlen(path);
+    char *partial = malloc(pathLength + sizeof(".partial"));
+    if(partial == NULL)
+        return false;
+    memcpy(partial, path, pathLength);
+    memcpy(partial + pathLength, ".partial", sizeof(".partial"));
+
+    FILE *out = fopen(partial, "wb");
+    if(out == NULL)
+    {
+        free(partial);
+        return false;
+    }
+
+    struct hierHeader_s header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, hierMagic, sizeof(hierMagic));
+    header.hash = hier->hash;
+    header.rows = hier->rows;
+    header.cols = hier->cols;
+    header.side = hier->side;
+    header.exact = hier->exact;
+    header.clusters = hier->clusters;
+    header.nodes = hier->nodes;
+    header.links = hier->links;
+    header.tableEntries = hier->tableFirst[hier->clusters];
+
+    size_t clusters = hier->clusters + 1, nodes = hier->nodes;
+    size_t entries = header.tableEntries;
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1 &&
+        fwrite(hier->tableFirst, sizeof(uint64_t), clusters, out) == clusters &&
+        fwrite(hier->clusterFirst, sizeof(uint32_t), clusters, out) ==
+            clusters &&
+        fwrite(hier->nodeCell, sizeof(uint32_t), nodes, out) == nodes &&
+        fwrite(hier->linkFirst, sizeof(uint32_t), nodes + 1, out) ==
+            nodes + 1 &&
+        fwrite(hier->linkTo, sizeof(uint32_t), hier->links, out) ==
+            hier->links &&
+        fwrite(hier->nodeRegion, sizeof(uint32_t), nodes, out) == nodes &&
+        fwrite(hier->tables, sizeof(uint16_t), entries, out) == entries;
+
+    // a failed close means the data may never have made it out
+    ok = (fclose(out) == 0) && ok;
+    ok = ok && rename(partial, path) == 0;
+
+    if(!ok)
+        remove(partial);
+    free(partial);
+
+    return ok;
+}
+
+
+///
+/// Function: createScratch
+///
+/// Description: Makes the working space of a query.
+///
+/// @return the working space, or NULL if the allocation fails.
+///
+static struct hierScratch_s * createScratch(Hierarchy hier)
+{
+    struct hierScratch_s *scratch = calloc(1, sizeof(struct hierScratch_s));
+    if(scratch == NULL)
+        return NULL;
+
+    // the most nodes any one cluster has
+    size_t widest = 1;
+    for(size_t c = 0; c < hier->clusters; ++c)
+        if(hier->clusterFirst[c + 1] - hier->clusterFirst[c] > widest)
+            widest = hier->clusterFirst[c + 1] - hier->clusterFirst[c];
+
+    size_t nodes = hier->nodes ? hier->nodes : 1;
+    size_t width = hier->side + 2;
+    scratch->best = malloc(nodes * sizeof(uint32_t));
+    scratch->stamps = calloc(nodes, sizeof(uint32_t));
+    scratch->open = heap_create(widest);
+    scratch->toGoal = malloc(widest * sizeof(uint32_t));
+    scratch->goalRegions = malloc(widest * sizeof(uint32_t));
+    scratch->grid = malloc(width * width);
+    scratch->local = malloc(width * width * sizeof(uint16_t));
+    scratch->queue = malloc(hier->side * hier->side * sizeof(uint32_t));
+
+    if(scratch->best == NULL || scratch->stamps == NULL ||
+       scratch->open == NULL || scratch->toGoal == NULL ||
+       scratch->goalRegions == NULL ||
+       scratch->grid == NULL || scratch->local == NULL ||
+       scratch->queue == NULL)
+    {
+        free(scratch->best);
+        free(scratch->stamps);
+        heap_destroy(scratch->open);
+        free(scratch->toGoal);
+        free(scratch->goalRegions);
+        free(scratch->grid);
+        free(scratch->local);
+        free(scratch->queue);
+        free(scratch);
+        return NULL;
+    }
+
+    return scratch;
+}
+
+
+///
+/// Function: remaining
+///
+/// Description: Gets the Manhattan distance from a node to the goal, which no
+///              path through the graph can beat (every link covers one step
+///              and every path inside a cluster at least as many steps as the
+///              distance between its ends).
+///
+static inline uint32_t remaining(Hierarchy hier, Maze maze, uint32_t node)
+{
+    size_t row = maze_row(maze, hier->nodeCell[node]),
+           col = maze_col(maze, hier->nodeCell[node]);
+    size_t goalRow = hier->scratch->goalRow, goalCol = hier->scratch->goalCol;
+
+    return (uint32_t) (((row > goalRow) ? row - goalRow : goalRow - row) +
+                       ((col > goalCol) ? col - goalCol : goalCol - col));
+}
+
+
+///
+/// Function: reach
+///
+/// Description: Offers a node a new distance, and queues it (by that distance
+///              and the distance it still has to go) if it is better than the
+///              one it had.
+///
+static inline void reach(Hierarchy hier, Maze maze, uint32_t node,
+                         uint32_t steps)
+{
+    struct hierScratch_s *scratch = hier->scratch;
+
+    if(scratch->stamps[node] != scratch->epoch || steps < scratch->best[node])
+    {
+        scratch->stamps[node] = scratch->epoch;
+        scratch->best[node] = steps;
+        heap_insert(scratch->open, steps + remaining(hier, maze, node), node);
+    }
+}
+
+
+/// searches the ends' clusters, then runs A* over the graph between them
+size_t hier_steps( Hierarchy hier, Maze maze, uint32_t start, uint32_t goal )
+{
+    // waste of time if we can't get in/out of the maze
+    if(bit_test(maze->walls, goal) || bit_test(maze->walls, start))
+        return 0;
+
+    // if we start on the goal, we're already done
+    if(start == goal)
+        return 1;
+
+    if(hier->scratch == NULL &&
+       (hier->scratch = createScratch(hier)) == NULL)
+    {
+        fprintf(stderr, "Unable to allocate a query of %zu nodes.\n",
+                hier->nodes);
+        exit(EXIT_FAILURE);
+    }
+
+    struct hierScratch_s *scratch = hier->scratch;
+    heap_clear(scratch->open);
+
+    // once every stamp has been used, they all start over
+    if(++scratch->epoch == 0)
+    {
+        memset(scratch->stamps, 0, hier->nodes * sizeof(uint32_t));
+        scratch->epoch = 1;
+    }
+
+    // the shortest path found so far, in steps
+    uint32_t found = UNREACHED;
+    scratch->goalRow = maze_row(maze, goal);
+    scratch->goalCol = maze_col(maze, goal);
+
+    // how far the goal is from every node of its cluster (and from the
+    // start, if it is in there too)
+    size_t width = hier->side + 2;
+    size_t goalCluster = clusterOf(hier, maze, goal);
+    uint32_t goalFirst = hier->clusterFirst[goalCluster],
+             goalLast = hier->clusterFirst[goalCluster + 1];
+    loadCluster(hier, maze, goalCluster, scratch->grid);
+    clusterSearch(width, scratch->grid, localIndex(hier, maze, goal),
+                  scratch->local, scratch->queue);
+    size_t goalRegions = 0;
+    for(uint32_t n = goalFirst; n < goalLast; ++n)
+    {
+        uint16_t steps = scratch->local[localIndex(hier, maze,
+                                                   hier->nodeCell[n])];
+        scratch->toGoal[n - goalFirst] = (steps == UINT16_MAX) ? UNREACHED
+                                                               : steps;
+        if(steps != UINT16_MAX)
+            scratch->goalRegions[goalRegions++] = hier->nodeRegion[n];
+    }
+    if(clusterOf(hier, maze, start) == goalCluster &&
+       scratch->local[localIndex(hier, maze, start)] != UINT16_MAX)
+        found = scratch->local[localIndex(hier, maze, start)];
+
+    // the nodes of the start's cluster are the way out of it (but only the
+    // ones in a region the goal can be reached from are worth taking)
+    size_t startCluster = clusterOf(hier, maze, start);
+    if(startCluster != goalCluster)
+        loadCluster(hier, maze, startCluster, scratch->grid);
+    clusterSearch(width, scratch->grid, localIndex(hier, maze, start),
+                  scratch->local, scratch->queue);
+    for(uint32_t n = hier->clusterFirst[startCluster];
+        n < hier->clusterFirst[startCluster + 1]; ++n)
+    {
+        uint16_t steps = scratch->local[localIndex(hier, maze,
+                                                   hier->nodeCell[n])];
+        if(steps == UINT16_MAX)
+            continue;
+
+        for(size_t r = 0; r < goalRegions; ++r)
+            if(scratch->goalRegions[r] == hier->nodeRegion[n])
+            {
+                reach(hier, maze, n, steps);
+                break;
+            }
+    }
+
+    stat_search();
+    while(!heap_empty(scratch->open))
+    {
+        stat_expand(1, heap_size(scratch->open));
+        HNode next = heap_remove(scratch->open);
+        uint32_t node = (uint32_t) next.value, steps = scratch->best[node];
+
+        // nothing left can beat what has been found
+        if(next.key >= found)
+            break;
+
+        // a node can be queued more than once; only its best counts
+        if(next.key != steps + remaining(hier, maze, node))
+            continue;
+
+        // a way into the goal's cluster
+        if(node >= goalFirst && node < goalLast &&
+           scratch->toGoal[node - goalFirst] != UNREACHED &&
+           steps + scratch->toGoal[node - goalFirst] < found)
+            found = steps + scratch->toGoal[node - goalFirst];
+
+        // the other nodes of its cluster...
+        size_t cluster = clusterOf(hier, maze, hier->nodeCell[node]);
+        uint32_t first = hier->clusterFirst[cluster],
+                 last = hier->clusterFirst[cluster + 1];
+        const uint16_t *row = hier->tables + hier->tableFirst[cluster] +
+                              (uint64_t) (node - first) * (last - first);
+        for(uint32_t to = first; to < last; ++to)
+            if(row[to - first] != UINT16_MAX)
+                reach(hier, maze, to, steps + row[to - first]);
+
+        // ...and the ones it faces in the next cluster over
+        for(uint32_t l = hier->linkFirst[node]; l < hier->linkFirst[node + 1];
+            ++l)
+            reach(hier, maze, hier->linkTo[l], steps + 1);
+    }
+
+    // the cells on the path are one more than the steps
+    return (found == UNREACHED) ? 0 : (size_t) found + 1;
+}
+
+
+/// frees the graph (or unmaps it, if it was loaded) and its working space
+void hier_destroy( Hierarchy hier )
+{
+    // nothing to do for a graph that was never made
+    if(hier == NULL)
+        return;
+
+    if(hier->scratch != NULL)
+    {
+        free(hier->scratch->best);
+        free(hier->scratch->stamps);
+        heap_destroy(hier->scratch->open);
+        free(hier->scratch->toGoal);
+        free(hier->scratch->goalRegions);
+        free(hier->scratch->grid);
+        free(hier->scratch->local);
+        free(hier->scratch->queue);
+        free(hier->scratch);
+    }
+
+    if(hier->mapping != NULL)
+        munmap(hier->mapping, hier->mappingLength);
+    else
+    {
+        free(hier->clusterFirst);
+        free(hier->nodeCell);
+        free(hier->linkFirst);
+        free(hier->linkTo);
+        free(hier->nodeRegion);
+        free(hier->tableFirst);
+        free(hier->tables);
+    }
+    free(hier);
+}
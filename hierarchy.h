@@ -0,0 +1,152 @@
+///
+/// File: hierarchy.h
+///
+/// Description: Interface to the Hierarchy module, an abstract graph of a Maze
+///              for answering queries on mazes too large to search each time
+///              (hierarchical pathfinding, in the style of HPA*).
+///
+///              The maze is cut into square clusters. Where open cells face
+///              each other across the edge of two clusters, the cells on
+///              either side are entrances; they become the nodes of the
+///              graph, linked one step to each other and, within a cluster,
+///              to every other entrance of it by the length of the shortest
+///              path that stays inside the cluster. A query searches the two
+///              clusters at its ends and then the graph, so it looks at a
+///              few thousand cells instead of the whole maze. The graph is
+///              searched with A* (no step through it is shorter than the
+///              Manhattan distance it covers), and the nodes are labeled by
+///              the region of the graph they are in, so a query between two
+///              regions is turned down without searching.
+///
+///              Normally a run of facing cells gets one entrance in its
+///              middle (two, at its ends, if it is long), which keeps the
+///              graph small but makes the answers close rather than exact
+///              (every path that exists is still found). An exact graph makes
+///              every facing cell an entrance, so any shortest path can be
+///              followed through it and the answers are exact.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#ifndef _HIERARCHY_H_
+#define _HIERARCHY_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "maze.h"
+
+// the side of a cluster, in cells, if no other is asked for
+#define HIER_SIDE 32
+
+// the largest side a cluster may have (a path inside it must fit 16 bits)
+#define HIER_MAX_SIDE 255
+
+// the working space of a query (made by the first query)
+struct hierScratch_s;
+
+// Hierarchy structure
+// NOTE: the nodes are sorted by cluster (clusters run row-major) and, within
+//       a cluster, by cell. Every cluster has a table of the distances (in
+//       steps, UINT16_MAX if there is no path inside the cluster) between
+//       every pair of its nodes, row-major by node.
+typedef struct hierarchy_s{
+    // the number of rows and columns of the maze the graph is for
+    size_t rows, cols;
+    // the maze_hash of the maze the graph is for
+    uint64_t hash;
+    // the side of a cluster, and whether every facing cell is an entrance
+    size_t side;
+    bool exact;
+    // the number of rows and columns of clusters, and of clusters
+    size_t clusterRows, clusterCols, clusters;
+    // the number of nodes, and of (one way) links between clusters
+    size_t nodes, links;
+    // the first node of every cluster (clusters + 1 entries)
+    uint32_t *clusterFirst;
+    // the packed index of the cell every node is
+    uint32_t *nodeCell;
+    // the first link of every node (nodes + 1 entries), and the node each
+    // link goes to
+    uint32_t *linkFirst, *linkTo;
+    // the connected region of the graph every node is in
+    uint32_t *nodeRegion;
+    // the first entry of every cluster's table (clusters + 1 entries), and
+    // the tables themselves
+    uint64_t *tableFirst;
+    uint16_t *tables;
+    // the file mapping the graph lives in (NULL if it was built)
+    void *mapping;
+    size_t mappingLength;
+    // the working space of a query
+    struct hierScratch_s *scratch;
+} * Hierarchy;
+
+///
+/// Builds the abstract graph of a maze.
+///
+/// @param maze  the maze to build the graph of.
+/// @param side  the side of a cluster (1 to HIER_MAX_SIDE).
+/// @param exact  true to make every facing cell an entrance.
+/// @param threads  the number of threads to measure the clusters with (at
+///                 least 1).
+///
+/// @return a Hierarchy instance, or NULL if the allocation fails.
+///
+Hierarchy hier_create( Maze maze, size_t side, bool exact,
+                       unsigned threads );
+
+///
+/// Loads a cached abstract graph, if the file holds one for this maze (by
+/// size and hash) built the same way. The file is mapped, not read.
+///
+/// @param path  the cache file.
+/// @param maze  the maze the graph must be for.
+/// @param side  the side of a cluster the graph must have.
+/// @param exact  whether the graph must be exact.
+///
+/// @return a Hierarchy instance, or NULL if there is no such file or it does
+///         not hold the graph asked for (or holds one that doesn't hold
+///         together, as a corrupted file might).
+///
+Hierarchy hier_load( const char *path, Maze maze, size_t side, bool exact );
+
+///
+/// Saves an abstract graph to a cache file. The file is written beside path
+/// and renamed into place, so a reader never sees half of one.
+///
+/// @param hier  the Hierarchy to save.
+/// @param path  the cache file.
+///
+/// @return true if the file was written; false otherwise.
+///
+bool hier_save( Hierarchy hier, const char *path );
+
+///
+/// Determines the number of steps from one cell to another through the
+/// abstract graph. Queries share the graph's working space, so only one may
+/// be asked at a time.
+///
+/// @param hier  the graph of the maze.
+/// @param maze  the maze the graph was built for.
+/// @param start  the packed index of the cell to start from.
+/// @param goal  the packed index of the cell to get to.
+///
+/// @return 0 if there is no path, otherwise the number of cells on the path
+///         found (the same count solve_bfs gives, if the graph is exact;
+///         never less than it, if it is not).
+/// @exception If the working space cannot be had, the program terminates
+///     with an error message printed to the standard error output and an
+///     exit status of EXIT_FAILURE.
+///
+size_t hier_steps( Hierarchy hier, Maze maze, uint32_t start, uint32_t goal );
+
+///
+/// Tear down and deallocate the supplied Hierarchy.
+///
+/// @param hier - the Hierarchy to be deallocated.
+///
+void hier_destroy( Hierarchy hier );
+
+#endif
@@ -0,0 +1,241 @@
+///
+/// File: maze.c
+///
+/// Description: A bit-packed grid of walls with a sentinel border.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#include <stdlib.h> // allocation functions
+#include <string.h> // memcpy, memset
+#include <sys/mman.h> // munmap
+#include "maze.h" // maze functions and structures
+
+
+///
+/// Function: buildBorder
+///
+/// Description: Walls off the sentinel border of a maze: the padded rows above
+///              and below it, the column on either side of it and all of the
+///              padding bits at the end of each row.
+///
+/// @param maze  The maze to wall off.
+///
+static void buildBorder(Maze maze)
+{
+    // the number of words in one padded row
+    size_t rowWords = maze->stride / 64;
+
+    // the top and bottom padded rows are entirely walls
+    memset(maze->walls, 0xff, rowWords * sizeof(uint64_t));
+    memset(maze->walls + (maze->rows + 1) * rowWords, 0xff,
+           rowWords * sizeof(uint64_t));
+
+    // every real row gets a wall on the west edge and from the east edge on
+    for(size_t r = 1; r <= maze->rows; ++r)
+    {
+        uint64_t *row = maze->walls + r * rowWords;
+
+        // the west sentinel
+        row[0] |= 1;
+
+        // the east sentinel and the padding behind it
+        for(size_t bit = maze->cols + 1; bit < maze->stride; ++bit)
+            row[bit >> 6] |= (uint64_t) 1 << (bit & 63);
+    }
+}
+
+
+///
+/// Function: createShell
+///
+/// Description: Allocates a maze and works out its layout, without a plane.
+///
+/// @param rows  The number of rows in the maze.
+/// @param cols  The number of columns in the maze.
+///
+/// @return the maze, or NULL if it is empty, too large to index with 32 bits
+///         or the allocation fails.
+///
+static Maze createShell(size_t rows, size_t cols)
+{
+    // we can't make an empty maze
+    if(rows == 0 || cols == 0)
+        return NULL;
+
+    // each row is padded with a sentinel on both sides, then up to 64 bits
+    size_t stride = ((cols + 2 + 63) / 64) * 64;
+
+    // every bit must be addressable with a 32-bit cell index
+    if((rows + 2) > ((size_t) UINT32_MAX + 1) / stride)
+        return NULL;
+
+    // pointer to a new maze (set to NULL for now)
+    Maze maze = NULL;
+    // allocates enough space for our maze
+    maze = malloc(sizeof(struct maze_s));
+
+    // if we encounter an error in creating our maze
+    if(maze == NULL)
+        return maze;
+
+    maze->rows = rows;
+    maze->cols = cols;
+    maze->stride = stride;
+    maze->words = (rows + 2) * (stride / 64);
+    maze->walls = NULL;
+    maze->mapping = NULL;
+    maze->mappingLength = 0;
+
+    return maze;
+}
+
+
+/// creates a maze with all cells open
+Maze maze_create( size_t rows, size_t cols )
+{
+    Maze maze = createShell(rows, cols);
+    if(maze == NULL)
+        return NULL;
+
+    // the whole plane is one zeroed allocation (every cell open)
+    maze->walls = calloc(maze->words, sizeof(uint64_t));
+    if(maze->walls == NULL)
+    {
+        free(maze);
+        return NULL;
+    }
+
+    // walls off the sentinel border
+    buildBorder(maze);
+
+    // returns our new, open maze
+    return maze;
+}
+
+
+/// creates a maze around a plane someone else filled in
+Maze maze_adopt( size_t rows, size_t cols, uint64_t *walls,
+                 void *mapping, size_t mappingLength )
+{
+    Maze maze = createShell(rows, cols);
+    if(maze == NULL)
+        return NULL;
+
+    maze->walls = walls;
+    maze->mapping = mapping;
+    maze->mappingLength = mappingLength;
+
+    return maze;
+}
+
+
+/// checks every bit buildBorder would have set is set
+bool maze_hasBorder( Maze maze )
+{
+    size_t rowWords = maze->stride / 64;
+    const uint64_t *bottom = maze->walls + (maze->rows + 1) * rowWords;
+
+    // the top and bottom padded rows
+    for(size_t w = 0; w < rowWords; ++w)
+        if(~maze->walls[w] || ~bottom[w])
+            return false;
+
+    // the bits of the last word of a row from the east sentinel on
+    size_t eastBit = (maze->cols + 1) & 63, eastWord = (maze->cols + 1) >> 6;
+    uint64_t eastMask = ~(((uint64_t) 1 << eastBit) - 1);
+
+    for(size_t r = 1; r <= maze->rows; ++r)
+    {
+        const uint64_t *row = maze->walls + r * rowWords;
+
+        if(!(row[0] & 1) || (row[eastWord] & eastMask) != eastMask)
+            return false;
+
+        // any whole words of padding after that
+        for(size_t w = eastWord + 1; w < rowWords; ++w)
+            if(~row[w])
+                return false;
+    }
+
+    return true;
+}
+
+
+/// destroys the maze, freeing (or unmapping) its plane
+void maze_destroy( Maze maze )
+{
+    // nothing to do for a maze that was never made
+    if(maze == NULL)
+        return;
+
+    if(maze->mapping != NULL)
+        munmap(maze->mapping, maze->mappingLength);
+    else
+        free(maze->walls);
+    free(maze);
+}
+
+
+/// ORs a packed row of walls into the maze, one column east of the sentinel
+void maze_fillRow( Maze maze, size_t row, const uint64_t *bits )
+{
+    // the padded row the bits belong in
+    uint64_t *dest = maze->walls + (row + 1) * (maze->stride / 64);
+    // the number of words of source bits
+    size_t words = (maze->cols + 63) / 64;
+    // the bit shifted out of the top of the previous word
+    uint64_t carry = 0;
+
+    // shifts every word up by one bit to make room for the west sentinel
+    for(size_t w = 0; w < words; ++w)
+    {
+        dest[w] |= (bits[w] << 1) | carry;
+        carry = bits[w] >> 63;
+    }
+
+    // the last column may spill into the next word
+    if(carry)
+        dest[words] |= carry;
+}
+
+
+/// hashes the size and wall plane of a maze (FNV-1a over whole words, with
+/// a final mix so every input bit reaches every output bit)
+uint64_t maze_hash( Maze maze )
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    hash = (hash ^ maze->rows) * 0x100000001b3ULL;
+    hash = (hash ^ maze->cols) * 0x100000001b3ULL;
+    for(size_t w = 0; w < maze->words; ++w)
+        hash = (hash ^ maze->walls[w]) * 0x100000001b3ULL;
+
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+
+/// creates a visitation map in which only the walls are visited
+uint64_t * maze_createVisitedMap( Maze maze )
+{
+    // one allocation for the whole map
+    uint64_t *visited = malloc(maze->words * sizeof(uint64_t));
+
+    // walls are never entered, so they start out "visited"
+    if(visited != NULL)
+        memcpy(visited, maze->walls, maze->words * sizeof(uint64_t));
+
+    return visited;
+}
+
+
+/// frees a visitation map
+void maze_clearVisitedMap( uint64_t *visited )
+{
+    free(visited);
+}
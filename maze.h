@@ -0,0 +1,242 @@
+///
+/// File: maze.h
+///
+/// Description: Interface to the Maze module, a bit-packed grid of walls.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#ifndef _MAZE_H_
+#define _MAZE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Maze structure
+// NOTE: the grid is stored one bit per cell (1 is a wall) in a single block.
+//       Every row is padded out to a multiple of 64 bits and the whole grid is
+//       surrounded by a border of sentinel walls, so cell (r, c) lives at bit
+//       (r + 1) * stride + (c + 1) and a neighbor test never needs a bounds
+//       check. Cells are referred to by that packed 32-bit bit index.
+typedef struct maze_s{
+    // the number of rows and columns in the maze (border not included)
+    size_t rows, cols;
+    // the number of bits in one padded row (a multiple of 64)
+    size_t stride;
+    // the number of 64-bit words in one plane (rows + 2 padded rows)
+    size_t words;
+    // the wall plane itself
+    uint64_t *walls;
+    // the file mapping the wall plane lives in (NULL if it was allocated)
+    void *mapping;
+    size_t mappingLength;
+} * Maze;
+
+///
+/// Create a Maze with every cell open.
+///
+/// @param rows  the number of rows in the maze.
+/// @param cols  the number of columns in the maze.
+///
+/// @return a Maze instance, or NULL if the maze is too large to index with 32
+///         bits or the allocation fails.
+///
+Maze maze_create( size_t rows, size_t cols );
+
+///
+/// Create a Maze around a wall plane that has already been filled in (the
+/// border included), laid out just as maze_create would lay it out.
+///
+/// @param rows  the number of rows in the maze.
+/// @param cols  the number of columns in the maze.
+/// @param walls  the wall plane; it must hold the number of words the maze
+///               works out to (maze->words).
+/// @param mapping  the file mapping walls lives in, which the maze unmaps
+///                 when it is destroyed; NULL if walls was malloc'd, in which
+///                 case the maze frees it.
+/// @param mappingLength  the length of the mapping.
+///
+/// @return a Maze instance, or NULL if the maze is empty or too large to index
+///         with 32 bits, or the allocation fails (walls is left alone).
+///
+Maze maze_adopt( size_t rows, size_t cols, uint64_t *walls,
+                 void *mapping, size_t mappingLength );
+
+///
+/// Determines if the sentinel border of a maze is all walls. A maze that came
+/// from anywhere other than maze_create must be checked before it is
+/// searched, since the searches count on the border to keep them inside it.
+///
+/// @param maze  the maze to check.
+///
+/// @return true if the border is intact; false otherwise.
+///
+bool maze_hasBorder( Maze maze );
+
+///
+/// Tear down and deallocate the supplied Maze.
+///
+/// @param maze - the Maze to be deallocated.
+///
+void maze_destroy( Maze maze );
+
+///
+/// Create a visitation map for the maze. The map has the same layout as the
+/// wall plane and starts as a copy of it, so walls (and the border) already
+/// count as visited and a single bit test decides if a cell may be entered.
+///
+/// @param maze  the maze the map is for.
+///
+/// @return the visitation map, or NULL if the allocation fails.
+///
+uint64_t * maze_createVisitedMap( Maze maze );
+
+///
+/// Frees a visitation map made by maze_createVisitedMap.
+///
+/// @param visited  the visitation map to free.
+///
+void maze_clearVisitedMap( uint64_t *visited );
+
+///
+/// Hashes the contents of a maze (its size and every wall), so a file made
+/// from a maze can tell if it still goes with it.
+///
+/// @param maze  the maze to hash.
+///
+/// @return a 64-bit hash of the maze.
+///
+uint64_t maze_hash( Maze maze );
+
+///
+/// Fills in the walls of one row of an open maze.
+///
+/// @param maze  the maze to change.
+/// @param row  the row to fill in.
+/// @param bits  the walls of the row packed 64 to a word (bit c of the row is
+///              column c); bits past the last column must be clear.
+///
+void maze_fillRow( Maze maze, size_t row, const uint64_t *bits );
+
+///
+/// Tests a bit of a plane.
+///
+/// @param plane  the plane to test.
+/// @param bit  the bit (cell index) to test.
+///
+/// @return true if the bit is set; false otherwise.
+///
+static inline bool bit_test( const uint64_t *plane, uint32_t bit )
+{
+    return (plane[bit >> 6] >> (bit & 63)) & 1;
+}
+
+///
+/// Sets a bit of a plane.
+///
+/// @param plane  the plane to change.
+/// @param bit  the bit (cell index) to set.
+///
+static inline void bit_set( uint64_t *plane, uint32_t bit )
+{
+    plane[bit >> 6] |= (uint64_t) 1 << (bit & 63);
+}
+
+///
+/// Clears a bit of a plane.
+///
+/// @param plane  the plane to change.
+/// @param bit  the bit (cell index) to clear.
+///
+static inline void bit_clear( uint64_t *plane, uint32_t bit )
+{
+    plane[bit >> 6] &= ~((uint64_t) 1 << (bit & 63));
+}
+
+///
+/// Gets the packed index of a cell.
+///
+/// @param maze  the maze the cell is in.
+/// @param row  the row of the cell.
+/// @param col  the column of the cell.
+///
+/// @return the packed index of (row, col).
+///
+static inline uint32_t maze_cell( const struct maze_s *maze,
+                                  size_t row, size_t col )
+{
+    return (uint32_t) ((row + 1) * maze->stride + col + 1);
+}
+
+///
+/// Gets the row of a packed cell index.
+///
+static inline size_t maze_row( const struct maze_s *maze, uint32_t cell )
+{
+    return cell / maze->stride - 1;
+}
+
+///
+/// Gets the column of a packed cell index.
+///
+static inline size_t maze_col( const struct maze_s *maze, uint32_t cell )
+{
+    return cell % maze->stride - 1;
+}
+
+///
+/// Gets the packed index of the neighbor to the EAST/SOUTH/WEST/NORTH of a
+/// cell. Thanks to the sentinel border the neighbor always exists.
+///
+static inline uint32_t maze_east( const struct maze_s *maze, uint32_t cell )
+{
+    (void) maze;
+    return cell + 1;
+}
+
+static inline uint32_t maze_south( const struct maze_s *maze, uint32_t cell )
+{
+    return cell + (uint32_t) maze->stride;
+}
+
+static inline uint32_t maze_west( const struct maze_s *maze, uint32_t cell )
+{
+    (void) maze;
+    return cell - 1;
+}
+
+static inline uint32_t maze_north( const struct maze_s *maze, uint32_t cell )
+{
+    return cell - (uint32_t) maze->stride;
+}
+
+///
+/// Determines if a cell is a wall.
+///
+/// @param maze  the maze to look in.
+/// @param row  the row of the cell.
+/// @param col  the column of the cell.
+///
+/// @return true if (row, col) is a wall; false otherwise.
+///
+static inline bool maze_isWall( const struct maze_s *maze,
+                                size_t row, size_t col )
+{
+    return bit_test(maze->walls, maze_cell(maze, row, col));
+}
+
+///
+/// Makes a cell a wall.
+///
+/// @param maze  the maze to change.
+/// @param row  the row of the cell.
+/// @param col  the column of the cell.
+///
+static inline void maze_setWall( Maze maze, size_t row, size_t col )
+{
+    bit_set(maze->walls, maze_cell(maze, row, col));
+}
+
+#endif
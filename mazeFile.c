@@ -0,0 +1,390 @@
+///
+/// File: mazeFile.c
+///
+/// Description: Reads and writes binary maze files. The header says how big
+///              the maze is and how its plane was laid out, so a loader can
+///              tell the plane is one it can use as is. The plane is stored in
+///              native byte order, one bit per cell with the sentinel border,
+///              exactly as maze.c keeps it.
+///
+///              An encoded plane is a list of runs, each a 64-bit word saying
+///              how many words it covers (count << 1) and whether it is a
+///              repeat (bit 0 set: the next word, count times) or a literal
+///              (bit 0 clear: the next count words as they are).
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#define _GNU_SOURCE
+#include <stdio.h> // file writing, rename
+#include <stdlib.h> // allocation functions
+#include <string.h> // memcmp, memcpy
+#include <unistd.h> // pread
+#include <sys/mman.h> // mmap
+#include "mazeFile.h" // maze file functions
+#include "stats.h" // instrumentation counters
+
+
+// the first bytes of every binary maze file (the last byte is the version)
+static const char mazeMagic[8] = { MAZE_FILE_MARK, 'O', 'P', 'M', 'A', 'Z', 'E',
+                                   1 };
+
+// the ways a plane can be stored
+enum { PLANE_RAW, PLANE_RUNS };
+
+// the shortest repeat worth its own run (shorter ones go in a literal)
+#define MIN_REPEAT 3
+
+// the header at the front of a binary maze file (64 bytes, so the plane after
+// it is aligned for 64-bit reads)
+struct mazeHeader_s{
+    char magic[8];
+    // the size of the maze
+    uint64_t rows, cols;
+    // the layout of the plane (bits per padded row, words in the plane)
+    uint64_t stride, words;
+    // how the plane is stored (PLANE_RAW or PLANE_RUNS)
+    uint64_t encoding;
+    // the number of bytes of plane data after the header
+    uint64_t payload;
+    uint64_t reserved;
+};
+
+
+/// checks for the magic at the start of a file
+bool mazeFile_isBinary( const void *bytes, size_t length )
+{
+    return length >= sizeof(mazeMagic) &&
+           memcmp(bytes, mazeMagic, sizeof(mazeMagic)) == 0;
+}
+
+
+///
+/// Function: checkHeader
+///
+/// Description: Makes sure a header describes a maze this build lays out the
+///              same way, and that the payload is all there.
+///
+/// @param *header  The header to check.
+/// @param available  The number of bytes there are after the header.
+///
+/// @return the maze the header describes, with no plane yet, or NULL if the
+///         header is no good.
+///
+static Maze checkHeader(const struct mazeHeader_s *header, size_t available)
+{
+    if(!mazeFile_isBinary(header->magic, sizeof(header->magic)) ||
+       header->payload != available || header->payload % sizeof(uint64_t) ||
+       (header->encoding != PLANE_RAW && header->encoding != PLANE_RUNS))
+        return NULL;
+
+    Maze maze = maze_adopt(header->rows, header->cols, NULL, NULL, 0);
+    if(maze == NULL)
+        return NULL;
+
+    // the plane has to be laid out just as we would lay it out
+    if(maze->stride != header->stride || maze->words != header->words ||
+       (header->encoding == PLANE_RAW &&
+        header->payload != maze->words * sizeof(uint64_t)))
+    {
+        free(maze);
+        return NULL;
+    }
+
+    return maze;
+}
+
+
+///
+/// Function: decodeRuns
+///
+/// Description: Expands an encoded plane.
+///
+/// @param *runs  The encoded plane.
+/// @param runWords  The number of words of encoded plane.
+/// @param *plane  Where the plane is expanded to.
+/// @param words  The number of words in the plane.
+///
+/// @return true if the runs fill the plane exactly; false otherwise.
+///
+static bool decodeRuns(const uint64_t *runs, size_t runWords,
+                       uint64_t *plane, size_t words)
+{
+    size_t in = 0, out = 0;
+
+    while(in < runWords)
+    {
+        uint64_t count = runs[in] >> 1;
+        bool repeat = runs[in] & 1;
+        ++in;
+
+        // a run may not go past the end of either the input or the plane
+        if(count > words - out || in + (repeat ? 1 : count) > runWords)
+            return false;
+
+        if(repeat)
+        {
+            for(uint64_t i = 0; i < count; ++i)
+                plane[out + i] = runs[in];
+            in += 1;
+        }
+        else
+        {
+            memcpy(plane + out, runs + in, count * sizeof(uint64_t));
+            in += count;
+        }
+        out += count;
+    }
+
+    return out == words;
+}
+
+
+///
+/// Function: finishMaze
+///
+/// Description: Makes sure a loaded maze has its border before it is used.
+///
+/// @param maze  The maze loaded.
+///
+/// @return the maze, or NULL if its border is broken (the maze is freed, but
+///         not any mapping it was using).
+///
+static Maze finishMaze(Maze maze)
+{
+    if(maze_hasBorder(maze))
+        return maze;
+
+    if(maze->mapping == NULL)
+        free(maze->walls);
+    free(maze);
+    return NULL;
+}
+
+
+/// maps a binary maze file (or decodes it, if it was encoded)
+Maze mazeFile_map( int fd, size_t fileSize )
+{
+    struct mazeHeader_s header;
+    Maze maze = NULL;
+
+    if(fileSize >= sizeof(header) &&
+       pread(fd, &header, sizeof(header), 0) == (ssize_t) sizeof(header))
+        maze = checkHeader(&header, fileSize - sizeof(header));
+
+    // writable so the maze can be changed, but private so the file never is
+    void *mapping = MAP_FAILED;
+    if(maze != NULL)
+        mapping = mmap(NULL, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                       fd, 0);
+
+    if(mapping == MAP_FAILED)
+    {
+        free(maze);
+        maze = NULL;
+    }
+    else if(header.encoding == PLANE_RAW)
+    {
+        // the plane is used right where it lies in the file
+        maze->walls = (uint64_t *) ((char *) mapping + sizeof(header));
+        maze->mapping = mapping;
+        maze->mappingLength = fileSize;
+        maze = finishMaze(maze);
+        if(maze == NULL)
+            munmap(mapping, fileSize);
+    }
+    else
+    {
+        // the plane has to be expanded into memory of its own
+        maze->walls = malloc(maze->words * sizeof(uint64_t));
+        if(maze->walls == NULL ||
+           !decodeRuns((const uint64_t *) ((char *) mapping + sizeof(header)),
+                       header.payload / sizeof(uint64_t), maze->walls,
+                       maze->words))
+        {
+            free(maze->walls);
+            free(maze);
+            maze = NULL;
+        }
+        else
+            maze = finishMaze(maze);
+        munmap(mapping, fileSize);
+    }
+
+    if(maze == NULL)
+        fprintf(stderr, "Malformed maze file.\n");
+
+    return maze;
+}
+
+
+/// reads a binary maze file from a stream
+Maze mazeFile_read( FILE *fileIn )
+{
+    struct mazeHeader_s header;
+    Maze maze = NULL;
+
+    // a stream can't tell us its size, so the header is trusted to, and we
+    // check the stream ends right where it says
+    if(fread(&header, sizeof(header), 1, fileIn) == 1)
+        maze = checkHeader(&header, header.payload);
+
+    uint64_t *payload = NULL;
+    if(maze != NULL)
+    {
+        payload = malloc(header.payload);
+        if(payload == NULL ||
+           fread(payload, 1, header.payload, fileIn) != header.payload ||
+           fgetc(fileIn) != EOF)
+        {
+            free(payload);
+            free(maze);
+            maze = NULL;
+        }
+    }
+
+    if(maze != NULL)
+        stat_read(sizeof(header) + header.payload);
+
+    if(maze != NULL && header.encoding == PLANE_RAW)
+    {
+        // the payload is the plane
+        maze->walls = payload;
+        maze = finishMaze(maze);
+    }
+    else if(maze != NULL)
+    {
+        maze->walls = malloc(maze->words * sizeof(uint64_t));
+        if(maze->walls == NULL ||
+           !decodeRuns(payload, header.payload / sizeof(uint64_t),
+                       maze->walls, maze->words))
+        {
+            free(maze->walls);
+            free(maze);
+            maze = NULL;
+        }
+        else
+            maze = finishMaze(maze);
+        free(payload);
+    }
+
+    if(maze == NULL)
+        fprintf(stderr, "Malformed maze file.\n");
+
+    return maze;
+}
+
+
+///
+/// Function: writeRuns
+///
+/// Description: Writes a plane out as runs.
+///
+/// @param *out  The file to write to.
+/// @param *plane  The plane to write.
+/// @param words  The number of words in the plane.
+///
+/// @return the number of bytes written, or 0 if a write failed.
+///
+static size_t writeRuns(FILE *out, const uint64_t *plane, size_t words)
+{
+    size_t written = 0, w = 0;
+
+    while(w < words)
+    {
+        // the length of the repeat starting here
+        size_t repeat = 1;
+        while(w + repeat < words && plane[w + repeat] == plane[w])
+            ++repeat;
+
+        if(repeat >= MIN_REPEAT)
+        {
+            uint64_t run[2] = { ((uint64_t) repeat << 1) | 1, plane[w] };
+            if(fwrite(run, sizeof(uint64_t), 2, out) != 2)
+                return 0;
+
+            written += sizeof(run);
+            w += repeat;
+            continue;
+        }
+
+        // a literal goes on until the next repeat worth its own run
+        size_t end = w + repeat;
+        while(end < words)
+        {
+            size_t next = 1;
+            while(end + next < words && next < MIN_REPEAT &&
+                  plane[end + next] == plane[end])
+                ++next;
+            if(next >= MIN_REPEAT)
+                break;
+            end += next;
+        }
+
+        uint64_t run = (uint64_t) (end - w) << 1;
+        if(fwrite(&run, sizeof(run), 1, out) != 1 ||
+           fwrite(plane + w, sizeof(uint64_t), end - w, out) != end - w)
+            return 0;
+
+        written += (1 + end - w) * sizeof(uint64_t);
+        w = end;
+    }
+
+    return written;
+}
+
+
+/// writes a binary maze file beside path, then renames it into place
+bool mazeFile_save( Maze maze, const char *path, bool encode )
+{
+    // the file we write to before it is finished
+    size_t pathLength = strlen(path);
+    char *partial = malloc(pathLength + sizeof(".partial"));
+    if(partial == NULL)
+        return false;
+    memcpy(partial, path, pathLength);
+    memcpy(partial + pathLength, ".partial", sizeof(".partial"));
+
+    FILE *out = fopen(partial, "wb");
+    if(out == NULL)
+    {
+        free(partial);
+        return false;
+    }
+
+    struct mazeHeader_s header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, mazeMagic, sizeof(mazeMagic));
+    header.rows = maze->rows;
+    header.cols = maze->cols;
+    header.stride = maze->stride;
+    header.words = maze->words;
+    header.encoding = (encode) ? PLANE_RUNS : PLANE_RAW;
+
+    // the header goes in first, then again once we know the payload size
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1;
+    if(ok && encode)
+    {
+        header.payload = writeRuns(out, maze->walls, maze->words);
+        ok = header.payload > 0 && fseek(out, 0, SEEK_SET) == 0 &&
+             fwrite(&header, sizeof(header), 1, out) == 1;
+    }
+    else if(ok)
+    {
+        header.payload = maze->words * sizeof(uint64_t);
+        ok = fwrite(maze->walls, sizeof(uint64_t), maze->words, out) ==
+             maze->words && fseek(out, 0, SEEK_SET) == 0 &&
+             fwrite(&header, sizeof(header), 1, out) == 1;
+    }
+
+    // a failed close means the data may never have made it out
+    ok = (fclose(out) == 0) && ok;
+    ok = ok && rename(partial, path) == 0;
+
+    if(!ok)
+        remove(partial);
+    free(partial);
+
+    return ok;
+}
@@ -0,0 +1,73 @@
+///
+/// File: mazeFile.h
+///
+/// Description: Interface to the binary maze file format. A binary maze file
+///              is a 64 byte header followed by the wall plane of the Maze,
+///              either exactly as it is laid out in memory (so it can be mapped
+///              and searched without being copied or parsed) or run-length
+///              encoded.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#ifndef _MAZE_FILE_H_
+#define _MAZE_FILE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "maze.h"
+
+// the first byte of every binary maze file (a text maze starts with a digit)
+#define MAZE_FILE_MARK 'M'
+
+///
+/// Determines if some bytes are the start of a binary maze file.
+///
+/// @param bytes  the first bytes of the file.
+/// @param length  the number of bytes given.
+///
+/// @return true if they start with the binary maze file magic.
+///
+bool mazeFile_isBinary( const void *bytes, size_t length );
+
+///
+/// Loads a binary maze file from disk. A plain file is mapped and the maze
+/// uses the mapped plane as its own; an encoded one is decoded into a new
+/// plane.
+///
+/// @param fd  the open file.
+/// @param fileSize  the size of the file.
+///
+/// @return the maze, or NULL if the file is not a valid binary maze (a message
+///         saying why has already been printed).
+///
+Maze mazeFile_map( int fd, size_t fileSize );
+
+///
+/// Reads a binary maze file from a stream, copying its plane in.
+///
+/// @param fileIn  the stream to read from, positioned at the start of the
+///                file.
+///
+/// @return the maze, or NULL if the stream is not a valid binary maze (a
+///         message saying why has already been printed).
+///
+Maze mazeFile_read( FILE *fileIn );
+
+///
+/// Saves a maze as a binary maze file. The file is written beside path and
+/// renamed into place, so a reader never sees half of one.
+///
+/// @param maze  the maze to save.
+/// @param path  the file to save it to.
+/// @param encode  whether to run-length encode the plane (smaller for mazes
+///                with long runs of open cells or walls, but it must then be
+///                decoded rather than mapped).
+///
+/// @return true if the file was written; false otherwise.
+///
+bool mazeFile_save( Maze maze, const char *path, bool encode );
+
+#endif
@@ -10,16 +10,37 @@
 
 #define _GNU_SOURCE
 #include <unistd.h> // getopt
+#include <getopt.h> // getopt_long
 #include <stdio.h> // printing
 #include <stdbool.h> // boolean items
+#include <stdint.h> // fixed width cell indices
 #include <string.h> // string functions
 #include <stdlib.h> // allocation functions
 #include "fileRead.h" // reading in the file
-#include "queue.h" // queue related items
+#include "maze.h" // the bit-packed maze
+#include "solve.h" // the search engines
+#include "batch.h" // answering streams of queries
+#include "distance.h" // cached distance fields
+#include "mazeFile.h" // binary maze files
+#include "components.h" // connected regions
+#include "dynamic.h" // distances kept up to date through changes
+#include "server.h" // serving mazes over a socket
+#include "tiled.h" // the maze kept in tiles
+#include "hierarchy.h" // the abstract graph of huge mazes
+#include "bench.h" // timing generated mazes
+#include "renderRow.h" // rendering rows of the maze as text
+#include "stats.h" // timing and counting the run
+
+// the most threads the user may ask for
+#define MAX_THREADS 1024
+
+// the size of the blocks printed mazes are rendered into and written out in
+#define PRINT_BLOCK (1 << 20)
 
 // used in our pretty-print function
 static char wall = 'O';
 static char empty = ' ';
+static char route = '.';
 
 
 ///
@@ -33,385 +54,540 @@ static void printHelpMsg(char *start)
 {
     // prints usage and exits
     printf("Usage:\n"
-           "%s [-hbsm] [-i INFILE] [-o OUTFILE]\n\n"
+           "%s [-hbsmpdcl] [-j N] [--algo=ALGO] [--layout=LAYOUT] [-q QUERIES]\n"
+           "    [--hpa[=exact]] [--reach=QUERIES] [--edit=COMMANDS]\n"
+           "    [--external=DIR] [--sweep[=ROWS]] [--convert=FILE [--rle]]\n"
+           "    [--stats[=JSON] [--perf]] [-i INFILE] [-o OUTFILE]\n"
+           "%s --serve=SOCKET [-j N] [--stats[=JSON]]\n"
+           "%s --bench=CASES [-j N] [--algo=ALGO] [--layout=LAYOUT]\n"
+           "    [-o OUTFILE]\n\n"
            "Options:\n"
            "-h Prints this message to stdout and exits.\n"
            "-b Add borders and pretty-print.     (Default: off)\n"
            "-s Add shortest solution step total. (Default: off)\n"
            "-m Print matrix after reading.       (Default: off)\n"
+           "-p Print the shortest path itself.   (Default: off)\n"
+           "   (As coordinates and over the maze)\n"
+           "-d Search from both ends for -s.     (Default: off)\n"
+           "   (Same as --algo=bidir)\n"
+           "-j N Search with N threads.          (Default: 1)\n"
+           "   (Only used by --algo=bfs, -q, --hpa and --serve)\n"
+           "--algo=ALGO Search engine for -s.    (Default: bfs)\n"
+           "   bfs, bidir, astar or jps\n"
+           "--layout=LAYOUT Grid layout for bfs. (Default: rows)\n"
+           "   rows, tiles (64x64) or morton (Z-ordered tiles)\n"
+           "--external=DIR Solve -s out of memory, keeping the\n"
+           "   visited cells and frontiers in files in DIR\n"
+           "   (For mazes larger than memory; give a --convert'd\n"
+           "   binary maze without --rle as INFILE)\n"
+           "--sweep[=ROWS] Solve -s a band of ROWS rows at a time\n"
+           "   (Holds far less than a whole visited map; smaller\n"
+           "   bands hold less but are searched more often)\n"
+           "-c Cache distances from the entrance.(Default: off)\n"
+           "   (Kept in INFILE.dist; used by -s and -q)\n"
+           "--hpa[=exact] Build an abstract graph of clusters\n"
+           "   (Kept in INFILE.hpa; used by -s and -q; close\n"
+           "   answers unless exact, which is larger)\n"
+           "-q QUERIES Answer each \"r1 c1 r2 c2\" line of QUERIES\n"
+           "   (- reads the queries from stdin)\n"
+           "-l Label connected regions first.    (Default: off)\n"
+           "   (-s and -p give up at once if the ends are apart)\n"
+           "--reach=QUERIES Say if each \"r1 c1 r2 c2\" can connect\n"
+           "   (Uses the labels of -l; - reads from stdin)\n"
+           "--edit=COMMANDS Run \"toggle r c\" and \"query [r c]\" lines\n"
+           "   (Distances are updated, not redone; - is stdin)\n"
+           "--convert=FILE Save maze to FILE as a binary maze\n"
+           "   (Loads with no parsing; INFILE may be either kind)\n"
+           "--rle Run-length encode the --convert file (Default: off)\n"
+           "--stats[=JSON] Report the time of each phase and the\n"
+           "   search counters to stderr at the end (and as a JSON\n"
+           "   object to the file JSON; - is stdout)\n"
+           "--perf Add hardware counters to --stats (Default: off)\n"
+           "   (Cycles, IPC, cache and branch misses of each phase;\n"
+           "   left out where the kernel doesn't allow them)\n"
            "-i INFILE Read maze from INFILE      (Default: stdin)\n"
-           "-o OUTFILE Write maze to OUTFILE     (Default: stdout)\n", start);
+           "-o OUTFILE Write maze to OUTFILE     (Default: stdout)\n"
+           "--serve=SOCKET Keep mazes loaded and answer requests\n"
+           "   on the Unix socket SOCKET (see server.h)\n"
+           "--bench=CASES Time reading, solving and printing\n"
+           "   generated mazes; each of the comma separated CASES\n"
+           "   is KIND:ROWSxCOLS[:DENSITY[:SEED]] (KIND is open,\n"
+           "   random, backtracker, serpentine or frontier), all\n"
+           "   for every kind from 10x10 to 4000x4000, or large for\n"
+           "   10000x10000 and 50000x50000 (5 GB of text each;\n"
+           "   see bench.h)\n",
+           start, start, start);
 }
 
 
 ///
-/// Function: getNumCols
+/// Function: createBlock
 ///
-/// Description: Gets the number of columns in the maze.
+/// Description: Allocates a block to render printed lines into before they are
+///              written out, large enough for at least one line.
 ///
-/// @param *file  The string representation of the maze.
+/// @param lineLength  The length of the longest line to be rendered.
+/// @param *capacity  Set to the number of characters the block holds (not
+///                   counting the slack renderRow may write past a line).
 ///
-/// @return the number of columns in the maze.
+/// @return the block.
+/// @exception If the block cannot be had, the program terminates with an
+///     error message printed to the standard error output and an exit status
+///     of EXIT_FAILURE.
 ///
-static size_t getNumCols(const char *fileString)
+static char * createBlock(size_t lineLength, size_t *capacity)
 {
-    // index counter, cols counter
-    size_t i = 0, cols = 0;
-    
-    // counts the number of non-space characters before first new line
-    while(fileString[i] != '\n')
-        if(fileString[i++] != ' ')
-            ++cols;
-    
-    // returns the number of columns we have
-    return cols;
+    *capacity = (lineLength > PRINT_BLOCK) ? lineLength : PRINT_BLOCK;
+
+    char *block = malloc(*capacity + RENDER_SLACK);
+    if(block == NULL)
+    {
+        fprintf(stderr, "Unable to allocate a %zu character print buffer.\n",
+                *capacity);
+        exit(EXIT_FAILURE);
+    }
+
+    return block;
 }
 
 
 ///
-/// Function: hasTrailingSpace
+/// Function: makeRoom
+///
+/// Description: Writes out the lines rendered so far if another line would not
+///              fit behind them.
+///
+/// @param *out  The file where the lines are printed.
+/// @param *block  The block the lines are rendered in.
+/// @param capacity  The number of characters the block holds.
+/// @param used  The number of characters rendered so far.
+/// @param lineLength  The length of the next line.
+///
+/// @return the number of characters rendered after the write (if any).
+///
+static size_t makeRoom(FILE * out, const char *block, size_t capacity,
+                       size_t used, size_t lineLength)
+{
+    if(used + lineLength <= capacity)
+        return used;
+
+    fwrite(block, 1, used, out);
+    return 0;
+}
+
+
 ///
-/// Description: Determines if there is an extra space at the end of each line.
+/// Function: printMatrix
 ///
-/// @param *fileString  The string representation of the maze.
+/// Description: Prints the maze back out in the format it was read in.
 ///
-/// @return true if there is a trailing space; false otherwise.
+/// @param *out  The file where the maze should be printed.
+/// @param maze  The maze to print.
 ///
-static bool hasTrailingSpace(const char *fileString)
+static void printMatrix(FILE * out, Maze maze)
 {
-    // index variable
-    size_t i = 0;
+    // each row is space separated 1s (walls) and 0s (open cells)
+    size_t lineLength = maze->cols * 2, capacity, used = 0;
+    char *block = createBlock(lineLength, &capacity);
+
+    for(size_t r = 0; r < maze->rows; ++r)
+    {
+        used = makeRoom(out, block, capacity, used, lineLength);
 
-    /* we can pre-increment because there will NEVER be a newline at position 0
-       searches until we find a new line character */
-    while(fileString[++i] != '\n');
+        // the space after the last column is the end of the line
+        renderRow(maze->walls + (r + 1) * (maze->stride / 64), maze->cols,
+                  '1', '0', block + used);
+        used += lineLength;
+        block[used - 1] = '\n';
+    }
 
-    // returns if the character before the new line was a space or not
-    return fileString[i-1] == ' ';
+    fwrite(block, 1, used, out);
+    free(block);
 }
 
 
 ///
-/// Function: createMaze
+/// Function: renderEdgeBorder
 ///
-/// Description: Creates a 2d array representing the maze input at the start.
+/// Description: Renders the border on the edge of the maze when
+///              pretty-printing.
 ///
-/// @param *fileString  The string representation of the maze.
-/// @param rows  The number of rows in the maze.
+/// @param *line  Where the border is rendered (cols * 2 + 4 characters).
 /// @param cols  The number of columns in the maze.
 ///
-/// @return the maze represented as a 2d array of booleans.
+static void renderEdgeBorder(char *line, const size_t cols)
+{
+    // the border itself, then the new line character at the end
+    memset(line, wall, cols * 2 + 3);
+    line[cols * 2 + 3] = '\n';
+}
+
+
+///
+/// Function: prettyPrintMaze
+///
+/// Description: Prints the maze in a nice format with a border. Rows are
+///              rendered into a block and written out a block at a time.
 ///
-static bool ** createMaze(const char *fileString,
-                          const size_t rows,
-                          const size_t cols)
+/// @param *out  The file where the maze should be printed.
+/// @param maze  The maze to print.
+/// @param onPath  A plane laid out like the maze with the cells on the path
+///                set, or NULL if there is no path to draw.
+///
+static void prettyPrintMaze(FILE * out, Maze maze, const uint64_t *onPath)
 {
-    // row/column index counters
-    size_t r, c, index;
-    
-    // our eventual storage location for our maze
-    bool **maze = NULL, trailingSpace = hasTrailingSpace(fileString);
-    // contiguously allocates the right number of rows
-    maze = calloc(sizeof(bool *), rows);
-    
-    // contiguously allocates the columns for each row
-    for(r = 0; r < rows; ++r)
-        maze[r] = calloc(sizeof(bool), cols);
-    
-    /* goes through each row and column and sets it to the proper value based
-       on the file string 
-       NOTE: the index in the file string is: (cols * row * 2) + (col * 2)
-             effectively this treats the 1d array as a 2d one :) */
-    for(r = 0; r < rows; ++r)
-        for(c = 0; c < cols; ++c)
-        {
-            // determines the index in the fileString we need to look at
-            index = (cols * (r * 2)) + (c * 2);
+    // the dimensions of the maze
+    size_t rows = maze->rows, cols = maze->cols;
+    size_t rowWords = maze->stride / 64;
 
-            // adds r to index if we have a trailing space to account for space
-            if(trailingSpace)
-                index += r;
+    // every line is a border, the cells (each after a space), a space and a
+    // border
+    size_t lineLength = cols * 2 + 4, capacity, used = 0;
+    char *block = createBlock(lineLength, &capacity);
 
-            maze[r][c] = (fileString[index] == '0') ? false : true;
-        }
-    
-    // we have finished building our maze we can now return it
-    return maze;
+    // renders our top border
+    renderEdgeBorder(block, cols);
+    used = lineLength;
+
+    // goes through and renders each row
+    for(size_t r = 0; r < rows; ++r)
+    {
+        used = makeRoom(out, block, capacity, used, lineLength);
+        char *line = block + used;
+
+        // if r is anything but 0, it starts with a wall (border)
+        line[0] = (r) ? wall : empty;
+        line[1] = ' ';
+        // renders the maze itself
+        renderRow(maze->walls + (r + 1) * rowWords, cols, wall, empty,
+                  line + 2);
+
+        // cells on the path are drawn over
+        if(onPath != NULL)
+            for(size_t w = 0; w < rowWords; ++w)
+                for(uint64_t bits = onPath[(r + 1) * rowWords + w]; bits;
+                    bits &= bits - 1)
+                {
+                    // the sentinel is bit 0, so the column is one less
+                    size_t c = w * 64 + (size_t) __builtin_ctzll(bits) - 1;
+                    if(c < cols)
+                        line[2 + c * 2] = route;
+                }
+
+        // if r is anything but rows-1 it ends with a wall (border)
+        line[cols * 2 + 2] = (r != rows-1) ? wall : empty;
+        line[cols * 2 + 3] = '\n';
+        used += lineLength;
+    }
+
+    // renders our bottom border
+    used = makeRoom(out, block, capacity, used, lineLength);
+    renderEdgeBorder(block + used, cols);
+    used += lineLength;
+
+    fwrite(block, 1, used, out);
+    free(block);
 }
 
 
 ///
-/// Function: clearMaze
+/// Function: printPath
 ///
-/// Description: Frees the maze from heapspace.
+/// Description: Prints the cells on a path as a list of coordinates.
 ///
-/// @param **maze  The maze to free.
-/// @param rows  The number of rows in the maze.
+/// @param *out  The file where the path should be printed.
+/// @param maze  The maze the path goes through.
+/// @param path  The packed indices of the cells on the path, start first.
+/// @param steps  The number of cells on the path.
 ///
-static void clearMaze(bool **maze, const size_t rows)
+static void printPath(FILE * out, Maze maze, const uint32_t *path,
+                      size_t steps)
 {
-    // frees each individual row
-    for(size_t r = 0; r < rows; ++r)
-        free(maze[r]);
-    
-    // finally frees our maze
-    free(maze);
+    fprintf(out, "Solution path:\n");
+    for(size_t i = 0; i < steps; ++i)
+        fprintf(out, "(%zu, %zu)\n", maze_row(maze, path[i]),
+                maze_col(maze, path[i]));
 }
 
 
 ///
-/// Function: printEdgeBorder
+/// Function: loadDistances
 ///
-/// Description: Prints the border on the edge of the maze when pretty-printing.
+/// Description: Gets the distance from the entrance to every cell. They are
+///              loaded from INFILE.dist if it was made for this maze, and
+///              otherwise worked out and saved there for next time.
 ///
-/// @param out  The file where the maze should be printed.
-/// @param cols  The number of columns in the maze.
+/// @param maze  The maze to measure.
+/// @param *inName  The file the maze was read from (NULL for stdin, in which
+///                 case nothing is cached).
 ///
-static void printEdgeBorder(FILE * out, const size_t cols)
+/// @return the distances, or NULL if they could not be had.
+///
+static DistField loadDistances(Maze maze, const char *inName)
 {
-    // prints our top border
-    for(size_t i = 0; i < cols * 2 + 3; ++i)
-        fprintf(out, "%c", wall);
-    // prints the new line character at the end
-    fprintf(out, "\n");
+    // the cache lives right next to the maze
+    char *cacheName = NULL;
+    if(inName != NULL && asprintf(&cacheName, "%s.dist", inName) < 0)
+        cacheName = NULL;
+
+    DistField field = NULL;
+    if(cacheName != NULL)
+        field = dist_load(cacheName, maze, 0, 0);
+
+    // not cached (or cached for some other maze), so works them out
+    if(field == NULL)
+    {
+        field = dist_create(maze, 0, 0);
+
+        // the distances are still good for this run if the cache can't be
+        // written, so this is only a warning
+        if(field != NULL && cacheName != NULL && !dist_save(field, cacheName))
+            fprintf(stderr, "Unable to write distance cache %s.\n",
+                    cacheName);
+    }
+
+    free(cacheName);
+    return field;
 }
 
 
 ///
-/// Function: prettyPrintMaze
+/// Function: loadHierarchy
 ///
-/// Description: Prints the maze in a nice format with a border.
+/// Description: Gets the abstract graph of the maze. It is loaded from
+///              INFILE.hpa if it was built for this maze the same way, and
+///              otherwise built and saved there for next time.
 ///
-/// @param *out  The file where the maze should be printed.
-/// @param **maze  The maze to print.
-/// @param rows  The number of rows in the maze.
-/// @param cols  The number of columns in the maze.
+/// @param maze  The maze to build the graph of.
+/// @param *inName  The file the maze was read from (NULL for stdin, in which
+///                 case nothing is cached).
+/// @param exact  true for a graph that gives exact answers.
+/// @param threads  The number of threads to build it with.
 ///
-static void prettyPrintMaze(FILE * out,
-                            bool **maze,
-                            const size_t rows,
-                            const size_t cols)
+/// @return the graph, or NULL if it could not be had.
+///
+static Hierarchy loadHierarchy(Maze maze, const char *inName, bool exact,
+                               unsigned threads)
 {
-    // prints our top border
-    printEdgeBorder(out, cols);
-    
-    // goes through and prints each character
-    for(size_t r = 0; r < rows; ++r)
+    // the cache lives right next to the maze
+    char *cacheName = NULL;
+    if(inName != NULL && asprintf(&cacheName, "%s.hpa", inName) < 0)
+        cacheName = NULL;
+
+    Hierarchy hier = NULL;
+    if(cacheName != NULL)
+        hier = hier_load(cacheName, maze, HIER_SIDE, exact);
+
+    // not cached (or cached for some other maze), so builds it
+    if(hier == NULL)
     {
-        // if r is anything but 0, print a wall (border)
-        fprintf(out, "%c", (r) ? wall : empty);
-        // prints the maze itself
-        for(size_t c = 0; c < cols; ++c)
-            fprintf(out, " %c", (maze[r][c]) ? wall : empty);
-        // if r is anything but rows-1 print a wall (border)
-        fprintf(out, " %c\n", (r != rows-1) ? wall : empty);
+        hier = hier_create(maze, HIER_SIDE, exact, threads);
+
+        // the graph is still good for this run if the cache can't be
+        // written, so this is only a warning
+        if(hier != NULL && cacheName != NULL && !hier_save(hier, cacheName))
+            fprintf(stderr, "Unable to write hierarchy cache %s.\n",
+                    cacheName);
     }
-    
-    // prints our bottom border
-    printEdgeBorder(out, cols);
+
+    free(cacheName);
+    return hier;
 }
 
 
 ///
-/// Function: createEmptyVisitedMap
+/// Function: findTiledSolution
 ///
-/// Description: Creates a 2d array of bools which will be used to keep track of
-///              visitation.
+/// Description: Determines the shortest number of steps from start to finish
+///              by searching a copy of the maze kept in tiles.
 ///
-/// @param rows  The number of rows in the maze.
-/// @param cols  The number of columns in the maze.
+/// @param maze  The maze to solve.
+/// @param order  The order to keep the tiles in.
 ///
-/// @return A 2d array of booleans all set to false.
+/// @return 0 if no path, otherwise the number of steps to get to the exit of
+///         the maze.
 ///
-static bool ** createEmptyVisitedMap(const size_t rows, const size_t cols)
+static size_t findTiledSolution(Maze maze, TileOrder order)
 {
-    // used to keep track of our visited nodes
-    bool ** visited = NULL;
-    
-    // this method is used so that all values are false upon return
-    visited = calloc(sizeof(bool *), rows);
-    
-    // contiguously allocates the columns for each row
-    for(size_t r = 0; r < rows; ++r)
-        visited[r] = calloc(sizeof(bool), cols);
-    
-    // returns new visited map with all values of FALSE
-    return visited;
+    // copies the maze into tiles (found in tiled.c)
+    TiledMaze tiled = tile_create(maze, order);
+    if(tiled == NULL)
+    {
+        fprintf(stderr, "Unable to tile a %zu x %zu maze.\n",
+                maze->rows, maze->cols);
+        exit(EXIT_FAILURE);
+    }
+
+    size_t steps = tile_solve(tiled, tile_cell(tiled, 0, 0),
+                              tile_cell(tiled, maze->rows - 1,
+                                        maze->cols - 1));
+    tile_destroy(tiled);
+
+    return steps;
 }
 
 
 ///
-/// Function: clearVisitedMap
+/// Function: findSolution
+///
+/// Description: Determines the shortest number of steps from start to finish.
 ///
-/// Description: Frees the visitation map from heapspace.
+/// @param maze  The maze to solve.
+/// @param algo  The search engine to use.
+/// @param threads  The number of threads to search with (BFS only).
+/// @param tiles  true to search a copy of the maze kept in tiles (BFS only).
+/// @param order  The order those tiles are kept in.
 ///
-/// @param ** visited  The visitation map to free.
-/// @param rows  The number of rows in the maze.
+/// @return 0 if no path, otherwise the number of steps to get to the exit of
+///         the maze.
 ///
-static void clearVisitedMap(bool ** visited, const size_t rows)
+static size_t findSolution(Maze maze, Algorithm algo, unsigned threads,
+                           bool tiles, TileOrder order)
 {
-    // contiguously allocates the columns for each row
-    for(size_t r = 0; r < rows; ++r)
-        free(visited[r]);
-        
-    // this method is used so that all values are false upon return
-    free(visited);
+    // the packed index of the entrance and exit
+    uint32_t entrance = maze_cell(maze, 0, 0),
+             exit = maze_cell(maze, maze->rows - 1, maze->cols - 1);
+
+    // searches with the engine the user asked for (found in solve.c/astar.c)
+    switch(algo)
+    {
+        case ALGO_BIDIR:
+            return solve_bidirectional(maze, entrance, exit);
+        case ALGO_ASTAR:
+            return solve_astar(maze, entrance, exit);
+        case ALGO_JPS:
+            return solve_jps(maze, entrance, exit);
+        case ALGO_BFS:
+        default:
+            // the tiled copy is searched instead if the user asked for it
+            if(tiles)
+                return findTiledSolution(maze, order);
+            return (threads > 1) ? solve_parallel(maze, entrance, exit, threads)
+                                 : solve_bfs(maze, entrance, exit);
+    }
 }
 
 
 ///
-/// Function: isExit
+/// Function: parseAlgorithm
 ///
-/// Description: Determines if at the exit of the maze.
+/// Description: Turns the name given to --algo into an Algorithm.
 ///
-/// @param location  The QNode of the location we are checking.
-/// @param rows  The number of rows in the maze.
-/// @param cols  The number of columns in the maze.
+/// @param name  The name of the search engine.
+/// @param algo  Where the engine is stored if the name is known.
 ///
-/// @return true if at exit; false otherwise.
+/// @return true if the name is a known engine, false otherwise.
 ///
-static bool isExit(QNode location, const size_t rows, const size_t cols)
+static bool parseAlgorithm(const char *name, Algorithm *algo)
 {
-    // if we are at rows-1 and cols-1 we can say we have found the solution
-    return (location->row == rows-1 && location->col == cols-1) ? true : false;
+    // the names we accept, in the same order as the Algorithm enum
+    static const char *names[] = { "bfs", "bidir", "astar", "jps" };
+
+    for(size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+        if(strcmp(name, names[i]) == 0)
+        {
+            *algo = (Algorithm) i;
+            return true;
+        }
+
+    return false;
 }
 
 
 ///
-/// Function: getNeighbors
+/// Function: parseLayout
 ///
-/// Description: Gets the neighbors of a certain location in the maze.
+/// Description: Turns the name given to --layout into a grid layout.
 ///
-/// @param maze  The boolean representation of the maze.
-/// @param visited  The boolean representation of the visitation maze.
-/// @param findFor  The node we are looking to find the neighbors of.
-/// @param queue  The queue we will insert neighbors to.
-/// @param rows  The number of rows in the maze.
-/// @param cols  The number of columns in the maze.
+/// @param name  The name of the layout.
+/// @param tiles  Set to true if the layout is tiled.
+/// @param order  Where the order of the tiles is stored if it is.
 ///
-static void getNeighbors(bool ** maze,
-                         bool ** visited,
-                         QNode findFor,
-                         Queue queue,
-                         const size_t rows,
-                         const size_t cols)
-{    
-    // the location we are searching from
-    size_t row = findFor->row, col = findFor->col;
-    // the number of steps if node is valid
-    size_t numSteps = findFor->steps + 1;
-    
-    // determines if EAST neighbor is valid and adds it to queue if it is;
-    // determined by: valid location, not a wall, and not already visited
-    // NOTE: for memory's sake, we mark it as visited here SO THE SAME NODE IS
-    //       NOT ADDED MORE THAN ONCE
-    if(col + 1 < cols && !maze[row][col+1] && !visited[row][col+1])
-    {
-        que_insert(queue, row, col+1, numSteps);
-        visited[row][col+1] = true;
-    }
-    // SOUTH...
-    if(row + 1 < rows && !maze[row+1][col] && !visited[row+1][col])
-    {
-        que_insert(queue, row+1, col, numSteps);
-        visited[row+1][col] = true;
-    }
-    // WEST...
-    if(col > 0 && !maze[row][col-1] && !visited[row][col-1])
+/// @return true if the name is a known layout, false otherwise.
+///
+static bool parseLayout(const char *name, bool *tiles, TileOrder *order)
+{
+    if(strcmp(name, "rows") == 0)
+        *tiles = false;
+    else if(strcmp(name, "tiles") == 0)
     {
-        que_insert(queue, row, col-1, numSteps);
-        visited[row][col-1] = true;
+        *tiles = true;
+        *order = TILE_ROWS;
     }
-    // NORTH...
-    if(row > 0 && !maze[row-1][col] && !visited[row-1][col])
+    else if(strcmp(name, "morton") == 0)
     {
-        que_insert(queue, row-1, col, numSteps);
-        visited[row-1][col] = true;
+        *tiles = true;
+        *order = TILE_MORTON;
     }
+    else
+        return false;
+
+    return true;
 }
 
 
+// the search settings a benchmark solves with
+struct solveSettings_s{
+    Algorithm algo;
+    unsigned threads;
+    bool tiles;
+    TileOrder order;
+};
+
+
 ///
-/// Function: findSolution
-///
-/// Description: Uses BFS to determine the shortest number of steps from start
-///              to finish.
-///
-/// @param **maze  The boolean representation of the maze.
-/// @param rows  The number of rows in our maze.
-/// @param cols  The number of columns in our maze.
+/// Function: benchSolve
 ///
-/// @return 0 if no path, otherwise the number of steps to get to the exit of
-///         the maze.
+/// Description: Solves a benchmark maze with the settings the user gave.
 ///
-static size_t findSolution(bool ** maze, const size_t rows, const size_t cols)
+static size_t benchSolve(Maze maze, const void *settings)
 {
-    /* we first check that the last and first spaces are open
-       waste of time if we can't get in/out of the maze */
-    if(maze[rows-1][cols-1] || maze[0][0])
-        return 0;
+    const struct solveSettings_s *with = settings;
+    return findSolution(maze, with->algo, with->threads, with->tiles,
+                        with->order);
+}
 
-    // the number of steps
-    size_t steps = 0;
 
-    // the node currently being searched
-    QNode searching = NULL;
+///
+/// Function: benchPrint
+///
+/// Description: Pretty-prints a benchmark maze, as -b does.
+///
+static void benchPrint(FILE *out, Maze maze)
+{
+    prettyPrintMaze(out, maze, NULL);
+}
 
-    // the visitation map (true is visited, false otherwise)
-    bool ** visited = NULL;
 
-    // creates a new queue here which will be used for BFS
-    // the queue of nodes left to search
-    Queue q = que_create();
-    
-    // inserts a node at (0,0) with 1 step (we must step into the maze first)
-    que_insert(q, 0, 0, 1);
-    
-    // used to keep track of visited nodes    
-    visited = createEmptyVisitedMap(rows, cols);
-
-    // keeps going while we still have queue nodes
-    while(!que_empty(q))
+///
+/// Function: reportStats
+///
+/// Description: Writes the stats of the run to stderr, and as JSON to a file.
+///
+/// @param *jsonName  The file the JSON goes to (- for stdout), or NULL for
+///                   none.
+///
+/// @return true if the report was written; false if the file couldn't be
+///         (the reason is printed).
+///
+static bool reportStats(const char *jsonName)
+{
+    FILE *json = NULL;
+    if(jsonName != NULL)
     {
-        // removes the next QNode
-        searching = que_remove(q);
-        
-        // if we are at solution we need to teardown
-        if(isExit(searching, rows, cols))
+        json = (strcmp(jsonName, "-") == 0) ? stdout : fopen(jsonName, "w");
+        if(json == NULL)
         {
-            // sets our number of steps and breaks the loop
-            steps = searching->steps;
-            break;
+            perror("Error opening stats file");
+            return false;
         }
-        // gets our valid neighbors and adds them to the queue if not at exit
-        else
-            getNeighbors(maze, visited, searching, q, rows, cols);
-        
-        // we're done with searching, we can free it
-        free(searching);
-        searching = NULL;
     }
-    
-    // frees our searching node if it isn't NULL
-    if(searching != NULL)
-    {
-        free(searching);
-        searching = NULL;
-    }
-    
-    /* destroys the remaining queue (we don't care, we've found shortest path)
-       might be empty already but hey that's okay */
-    que_destroy(q);
-    q = NULL;
-    
-    
-    // clears our matrix
-    clearVisitedMap(visited, rows);
-    visited = NULL;
 
-    /* if steps is STILL 0 here we have run out of spaces to inspect and there
-       is no solution */
-    return steps;
+    stat_report(stderr, json);
+
+    if(json != NULL && json != stdout)
+        fclose(json);
+    return true;
 }
 
 
@@ -427,18 +603,89 @@ int main(int argc, char **argv)
 {
     // these are used for after we read in our stuff
     unsigned char prettyPrint = 0, solutionSteps = 0, matrix = 0;
+    unsigned char showPath = 0, cacheDistances = 0, encode = 0, label = 0;
+    unsigned char hierarchy = 0, exactHierarchy = 0;
+
+    // where to save a binary copy of the maze (NULL if nowhere)
+    const char *convertTo = NULL;
+
+    // the search engine to use for -s
+    Algorithm algo = ALGO_BFS;
+
+    // the grid layout a single threaded BFS searches in
+    bool tiles = false;
+    TileOrder order = TILE_ROWS;
+
+    // the number of threads to search with
+    unsigned threads = 1;
     
-    // holds the number of rows and columns in our matrix
-    size_t rows = 0, cols = 0, steps = 0;
+    // holds the number of steps in our solution
+    size_t steps = 0;
+
+    // the cells on the solution (only found for -p) and the same cells as a
+    // plane for drawing them
+    uint32_t *path = NULL;
+    uint64_t *onPath = NULL;
     
     // sets our default file in and out
     FILE *fileIn = stdin, *fileOut = stdout;
+
+    // where queries are read from for -q and --reach (NULL if there are none)
+    FILE *queries = NULL, *reachQueries = NULL, *edits = NULL;
+
+    // the connected regions of the maze, for -l
+    Components comps = NULL;
+
+    // the name of the maze file (NULL for stdin) and, for -c, the distances
+    // from the entrance
+    const char *inName = NULL;
+    DistField field = NULL;
+
+    // the abstract graph of the maze, for --hpa
+    Hierarchy hier = NULL;
+
+    // the socket to serve on (NULL to solve the one maze and exit)
+    const char *serveOn = NULL;
+
+    // the benchmark cases to run (NULL to solve the one maze and exit)
+    const char *benchCases = NULL;
+
+    // where an out of memory search keeps its files (NULL to search in memory)
+    const char *externalDir = NULL;
+
+    // whether to search a band of rows at a time, and the rows in a band (0
+    // for the smallest footprint)
+    bool sweep = false;
+    size_t bandRows = 0;
+
+    // whether to report the stats at the end, and where their JSON goes (NULL
+    // for nowhere)
+    bool stats = false, perf = false;
+    const char *statsJson = NULL;
     
     // used for processing the flags
     int opt;
+
+    // the flags that only have a long name
+    static const struct option longOpts[] = {
+        { "algo", required_argument, NULL, 'a' },
+        { "layout", required_argument, NULL, 'L' },
+        { "convert", required_argument, NULL, 'C' },
+        { "rle", no_argument, NULL, 'R' },
+        { "reach", required_argument, NULL, 'r' },
+        { "edit", required_argument, NULL, 'e' },
+        { "serve", required_argument, NULL, 'S' },
+        { "hpa", optional_argument, NULL, 'H' },
+        { "bench", required_argument, NULL, 'B' },
+        { "external", required_argument, NULL, 'x' },
+        { "sweep", optional_argument, NULL, 'W' },
+        { "stats", optional_argument, NULL, 'T' },
+        { "perf", no_argument, NULL, 'P' },
+        { NULL, 0, NULL, 0 }
+    };
     
     // processes our flags (if any are present)
-    while((opt = getopt(argc, argv, "hbsmi:o:")) != -1)
+    while((opt = getopt_long(argc, argv, "hbsmpdclj:q:i:o:", longOpts, NULL)) != -1)
     {
         switch(opt)
         {
@@ -458,10 +705,62 @@ int main(int argc, char **argv)
             case 'm':
                 matrix = 1;
                 break;
+            // flag to print the path itself (which also gives its length)
+            case 'p':
+                showPath = 1;
+                solutionSteps = 1;
+                prettyPrint = 1;
+                break;
+            // flag to search from both ends of the maze
+            case 'd':
+                algo = ALGO_BIDIR;
+                break;
+            // flag to save the maze as a binary maze file
+            case 'C':
+                convertTo = optarg;
+                break;
+            // flag to run-length encode that file
+            case 'R':
+                encode = 1;
+                break;
+            // flag to pick the search engine
+            case 'a':
+                if(!parseAlgorithm(optarg, &algo))
+                {
+                    fprintf(stderr, "Unknown search engine: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            // flag to pick the grid layout
+            case 'L':
+                if(!parseLayout(optarg, &tiles, &order))
+                {
+                    fprintf(stderr, "Unknown layout: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            // flag to set the number of search threads
+            case 'j':
+            {
+                // checked before it is narrowed, so it can't wrap into range
+                char *end;
+                unsigned long count = strtoul(optarg, &end, 10);
+                // we need at least one thread to search with
+                if(end == optarg || *end != '\0' || count < 1 ||
+                   count > MAX_THREADS)
+                {
+                    fprintf(stderr, "Thread count must be 1 to %d.\n",
+                            MAX_THREADS);
+                    return EXIT_FAILURE;
+                }
+                threads = (unsigned) count;
+                break;
+            }
             // flag preset to set our fileIn
             case 'i':
                 // opens the in file in read-only mode
                 fileIn = fopen(optarg, "r");
+                inName = optarg;
                 /* if the file doesn't exist (i.e. fopen returns NULL), print
                    the error and exit */
                 if(fileIn == NULL)
@@ -470,6 +769,92 @@ int main(int argc, char **argv)
                     return EXIT_FAILURE;
                 }
                 break;
+            // flag to keep the distances from the entrance
+            case 'c':
+                cacheDistances = 1;
+                break;
+            // flag to label the regions of the maze
+            case 'l':
+                label = 1;
+                break;
+            // flag to answer a file of reachability queries (needs labels)
+            case 'r':
+                label = 1;
+                reachQueries = (strcmp(optarg, "-") == 0) ? stdin
+                                                          : fopen(optarg, "r");
+                if(reachQueries == NULL)
+                {
+                    perror("Error opening query file");
+                    return EXIT_FAILURE;
+                }
+                break;
+            // flag to run a file of toggle and query commands
+            case 'e':
+                edits = (strcmp(optarg, "-") == 0) ? stdin
+                                                   : fopen(optarg, "r");
+                if(edits == NULL)
+                {
+                    perror("Error opening command file");
+                    return EXIT_FAILURE;
+                }
+                break;
+            // flag to build the abstract graph (exact if asked)
+            case 'H':
+                hierarchy = 1;
+                if(optarg != NULL && strcmp(optarg, "exact") == 0)
+                    exactHierarchy = 1;
+                else if(optarg != NULL)
+                {
+                    fprintf(stderr, "Unknown hierarchy: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            // flag to run as a server instead
+            case 'S':
+                serveOn = optarg;
+                break;
+            // flag to search out of memory
+            case 'x':
+                externalDir = optarg;
+                break;
+            // flag to search a band of rows at a time
+            case 'W':
+                sweep = true;
+                if(optarg != NULL)
+                {
+                    char *end;
+                    bandRows = (size_t) strtoull(optarg, &end, 10);
+                    if(end == optarg || *end != '\0' || bandRows == 0)
+                    {
+                        fprintf(stderr, "Band rows must be at least 1.\n");
+                        return EXIT_FAILURE;
+                    }
+                }
+                break;
+            // flag to report the stats at the end
+            case 'T':
+                stats = true;
+                statsJson = optarg;
+                break;
+            // flag to add the hardware counters to the stats
+            case 'P':
+                perf = true;
+                stats = true;
+                break;
+            // flag to run a benchmark instead
+            case 'B':
+                benchCases = optarg;
+                break;
+            // flag to answer a file of queries
+            case 'q':
+                queries = (strcmp(optarg, "-") == 0) ? stdin
+                                                     : fopen(optarg, "r");
+                if(queries == NULL)
+                {
+                    perror("Error opening query file");
+                    return EXIT_FAILURE;
+                }
+                break;
             case 'o':
                 /* open our output file in w+ mode which will create the file
                    if it doesn't exist and overwrite if it does */
@@ -484,62 +869,215 @@ int main(int argc, char **argv)
         }
     }
 
-    /* gets our file as a string (found in fildRead.c)
-       NOTE: we can read a lot faster if we are reading from a file; we must be
-             much more careful when reading from stdin */
-    char *fileString = getFileAsString(fileIn);
+    // the server loads its own mazes, so nothing else is done (found in
+    // server.c)
+    if(serveOn != NULL)
+    {
+        bool served = server_run(serveOn, threads);
+        if(stats && !reportStats(statsJson))
+            served = false;
+        return served ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // the benchmark makes its own mazes too (found in bench.c)
+    if(benchCases != NULL)
+    {
+        struct solveSettings_s settings = { algo, threads, tiles, order };
+        BenchStages stages = { benchSolve, benchPrint, &settings };
+        bool ran = bench_run(fileOut, benchCases, &stages);
+
+        if(fileOut != stdout)
+            fclose(fileOut);
+        return ran ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
 
-    // if there is no maze to build from, we need to exit now!
-    if(strlen(fileString) == 0)
+    // stdin can only hold one of the maze and the queries
+    if((queries == stdin || reachQueries == stdin || edits == stdin) &&
+       fileIn == stdin)
     {
-        printf("No maze specified.\n");
+        fprintf(stderr, "Queries can only be read from stdin with -i.\n");
         return EXIT_FAILURE;
     }
+
+    /* reads in our maze (found in fileRead.c)
+       NOTE: we can read a lot faster if we are reading from a file; it is
+             mapped and parsed in place rather than read in line by line */
+    // opens the hardware counters before any search threads are started, so
+    // they are counted too (if none can be had the stats go on without them)
+    if(perf)
+        stat_perfOpen();
+
+    stat_start(STAT_READ);
+    Maze maze = getMaze(fileIn);
+    stat_stop(STAT_READ);
+
+    // if there is no maze to solve, we need to exit now! (reason was printed)
+    if(maze == NULL)
+        return EXIT_FAILURE;
     
     // we are done reading in from the file at this point, close it if necessary
     if(fileIn != stdin)
         fclose(fileIn);
     
-    /* prints our matrix if we were asked to do so by the user
-       there is a new line at the end of our matrix, we don't need an extra */
+    // prints our matrix if we were asked to do so by the user
     if(matrix)
-        fprintf(fileOut, "Read this matrix:\n%s", fileString);
-
-    // determines the number of columns and rows we are dealing with
-    cols = getNumCols(fileString);
-    /* rows is the length of the string divided by twice the number of cols
-       this is because there are spaces or new lines separating each column, 
-       thus we need to account for that. */
-    rows = (strlen(fileString) / (2 * cols));
-    
-    // process file string to create our maze--a boolean matrix
-    bool **maze = createMaze(fileString, rows, cols);
-    
-    // file is all done, we can free it here and set file to NULL
-    free(fileString);
-    fileString = NULL;
+    {
+        stat_start(STAT_PRINT);
+        fprintf(fileOut, "Read this matrix:\n");
+        printMatrix(fileOut, maze);
+        stat_stop(STAT_PRINT);
+    }
+
+    // saves the binary copy of the maze (found in mazeFile.c)
+    if(convertTo != NULL && !mazeFile_save(maze, convertTo, encode))
+    {
+        perror("Error writing binary maze");
+        maze_destroy(maze);
+        return EXIT_FAILURE;
+    }
+
+    // gets the distances from the entrance, from the cache if they're there
+    stat_start(STAT_PREPARE);
+    if(cacheDistances)
+        field = loadDistances(maze, inName);
+
+    // gets the abstract graph, from the cache if it's there (found in
+    // hierarchy.c)
+    if(hierarchy)
+    {
+        hier = loadHierarchy(maze, inName, exactHierarchy, threads);
+        if(hier == NULL)
+        {
+            fprintf(stderr, "Unable to build the hierarchy of a %zu x %zu "
+                    "maze.\n", maze->rows, maze->cols);
+            maze_destroy(maze);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // labels the regions of the maze (found in components.c)
+    if(label)
+    {
+        comps = comp_create(maze);
+        if(comps == NULL)
+        {
+            fprintf(stderr, "Unable to label a %zu x %zu maze.\n",
+                    maze->rows, maze->cols);
+            maze_destroy(maze);
+            return EXIT_FAILURE;
+        }
+    }
+    stat_stop(STAT_PREPARE);
 
     // if the user wants the number of steps to find solution, print that now
     if(solutionSteps)
     {
+        stat_start(STAT_SOLVE);
         /* steps is set to the return of findSolution which returns the number
-           of steps in the shortest path */
-        steps = findSolution(maze, rows, cols);
+           of steps in the shortest path; -p needs the path itself, which
+           solve_path (found in path.c) finds along with its length */
+        if(comps != NULL &&
+           !comp_connected(comps, 0, 0, maze->rows - 1, maze->cols - 1))
+            steps = 0;
+        else if(showPath)
+            steps = solve_path(maze, maze_cell(maze, 0, 0),
+                               maze_cell(maze, maze->rows - 1, maze->cols - 1),
+                               &path);
+        else if(field != NULL)
+            steps = dist_steps(field, maze->rows - 1, maze->cols - 1);
+        else if(hier != NULL)
+            steps = hier_steps(hier, maze, maze_cell(maze, 0, 0),
+                               maze_cell(maze, maze->rows - 1,
+                                         maze->cols - 1));
+        else if(externalDir != NULL)
+            steps = solve_external(maze, maze_cell(maze, 0, 0),
+                                   maze_cell(maze, maze->rows - 1,
+                                             maze->cols - 1), externalDir);
+        else if(sweep)
+            steps = solve_sweep(maze, maze_cell(maze, 0, 0),
+                                maze_cell(maze, maze->rows - 1,
+                                          maze->cols - 1), bandRows);
+        else
+            steps = findSolution(maze, algo, threads, tiles, order);
+        stat_stop(STAT_SOLVE);
 
-        
         // if steps is not -1 (a.k.a. there WAS a path), that is returned here.
         if (steps > 0)
             fprintf(fileOut, "Solution in %zu steps.\n", steps);
         else
             fprintf(fileOut, "No solution.\n");
+
+        // lists the path and marks it out for the pretty print
+        if(path != NULL)
+        {
+            printPath(fileOut, maze, path, steps);
+
+            onPath = calloc(maze->words, sizeof(uint64_t));
+            if(onPath != NULL)
+                for(size_t i = 0; i < steps; ++i)
+                    bit_set(onPath, path[i]);
+        }
     }
 
+    // answers the queries, loading the maze just the once (found in batch.c)
+    stat_start(STAT_QUERY);
+    if(queries != NULL)
+    {
+        if(hier != NULL)
+            batch_hier(maze, hier, queries, fileOut);
+        else
+            batch_run(maze, field, queries, fileOut, threads);
+        if(queries != stdin)
+            fclose(queries);
+    }
+
+    // answers the reachability queries from the labels (found in batch.c)
+    if(reachQueries != NULL)
+    {
+        batch_reach(maze, comps, reachQueries, fileOut);
+        if(reachQueries != stdin)
+            fclose(reachQueries);
+    }
+
+    // runs the commands, which change the maze as they go (found in batch.c)
+    if(edits != NULL)
+    {
+        Dynamic dyn = dyn_create(maze, 0, 0);
+        if(dyn == NULL)
+        {
+            fprintf(stderr, "Unable to measure a %zu x %zu maze.\n",
+                    maze->rows, maze->cols);
+            maze_destroy(maze);
+            return EXIT_FAILURE;
+        }
+
+        batch_edit(dyn, edits, fileOut);
+        dyn_destroy(dyn);
+        if(edits != stdin)
+            fclose(edits);
+    }
+    stat_stop(STAT_QUERY);
+
     // pretty prints our board if we were asked to do so by user
     if(prettyPrint)
-        prettyPrintMaze(fileOut, maze, rows, cols);
+    {
+        stat_start(STAT_PRINT);
+        prettyPrintMaze(fileOut, maze, onPath);
+        stat_stop(STAT_PRINT);
+    }
+
+    // reports the stats while the maze is still on the heap
+    bool reported = !stats || reportStats(statsJson);
+
+    // done with the path, distances and labels
+    free(path);
+    free(onPath);
+    dist_destroy(field);
+    hier_destroy(hier);
+    comp_destroy(comps);
 
     // empties out the maze since it is done
-    clearMaze(maze, rows);
+    maze_destroy(maze);
     maze = NULL;
     
     // if we need to close the output file we do it right before exit
@@ -547,5 +1085,5 @@ int main(int argc, char **argv)
         fclose(fileOut);
         
     // lastly we need to return that we have successfully run the program
-    return EXIT_SUCCESS;
+    return reported ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -0,0 +1,303 @@
+///
+/// File: parallel.c
+///
+/// Description: A multithreaded, level-synchronous BFS. Each level of the
+///              frontier is split into chunks which the threads claim one at a
+///              time; every thread collects the cells it discovers in its own
+///              buffer and the buffers are then stitched together into the next
+///              frontier. Cells are claimed with an atomic test-and-set on the
+///              visited bitmap so each is added exactly once.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#define _GNU_SOURCE
+#include <pthread.h> // threads and barriers
+#include <stdbool.h> // boolean items
+#include <stdio.h> // error reporting
+#include <stdlib.h> // allocation functions
+#include <string.h> // memcpy, strerror
+#include "solve.h" // the function we need to write is in here
+#include "stats.h" // instrumentation counters
+
+
+// the number of frontier cells a thread claims at once
+#define CHUNK 256
+
+
+// the state shared by every thread of one search
+struct shared_s{
+    // the maze being searched and the cell we are looking for
+    Maze maze;
+    uint32_t goal;
+    // the visitation map (walls are marked as visited)
+    uint64_t *visited;
+    // the frontier being expanded and the one being built
+    uint32_t *frontier, *next;
+    size_t frontierSize, frontierCapacity, nextCapacity;
+    // the next frontier cell to be claimed
+    size_t cursor;
+    // the number of steps to the cells in the frontier
+    size_t levelSteps;
+    // set once the goal has been found, or there is nothing left to search
+    bool found, done;
+    // the point every thread waits at between phases
+    pthread_barrier_t barrier;
+    // every thread of the search
+    struct worker_s *workers;
+    unsigned threads;
+};
+
+// the state owned by one thread
+struct worker_s{
+    pthread_t thread;
+    // the search this thread is a part of
+    struct shared_s *shared;
+    // the cells this thread discovered this level
+    uint32_t *local;
+    size_t localSize, localCapacity;
+    // where this thread's cells go in the next frontier
+    size_t offset;
+};
+
+
+///
+/// Function: growArray
+///
+/// Description: Makes sure an array of cells can hold at least size cells,
+///              doubling it as needed.
+///
+/// @param **cells  The array to grow.
+/// @param *capacity  The number of cells the array holds.
+/// @param size  The number of cells it must be able to hold.
+///
+static void growArray(uint32_t **cells, size_t *capacity, size_t size)
+{
+    if(size <= *capacity)
+        return;
+
+    size_t grown = (*capacity) ? *capacity : CHUNK;
+    while(grown < size)
+        grown <<= 1;
+
+    uint32_t *bigger = realloc(*cells, grown * sizeof(uint32_t));
+
+    // we cannot continue the search without space for the frontier
+    if(bigger == NULL)
+    {
+        fprintf(stderr, "Unable to grow frontier to %zu cells.\n", grown);
+        exit(EXIT_FAILURE);
+    }
+
+    *cells = bigger;
+    *capacity = grown;
+}
+
+
+///
+/// Function: claimNeighbor
+///
+/// Description: Atomically claims a neighbor, adding it to this thread's list
+///              of discovered cells if no other thread got to it first.
+///
+/// @param *worker  The thread doing the claiming.
+/// @param cell  The neighbor to claim.
+///
+static void claimNeighbor(struct worker_s *worker, uint32_t cell)
+{
+    struct shared_s *shared = worker->shared;
+    uint64_t *word = &shared->visited[cell >> 6];
+    uint64_t mask = (uint64_t) 1 << (cell & 63);
+
+    // a cheap look first, most neighbors have already been taken
+    if(__atomic_load_n(word, __ATOMIC_RELAXED) & mask)
+        return;
+
+    // only the thread that actually flips the bit gets the cell
+    if(__atomic_fetch_or(word, mask, __ATOMIC_RELAXED) & mask)
+        return;
+
+    if(cell == shared->goal)
+        __atomic_store_n(&shared->found, true, __ATOMIC_RELAXED);
+
+    growArray(&worker->local, &worker->localCapacity, worker->localSize + 1);
+    worker->local[worker->localSize++] = cell;
+}
+
+
+///
+/// Function: searchLevels
+///
+/// Description: The loop every thread of the search runs, one level at a time.
+///
+/// @param *arg  The worker_s of this thread.
+///
+/// @return NULL
+///
+static void * searchLevels(void *arg)
+{
+    struct worker_s *worker = arg;
+    struct shared_s *shared = worker->shared;
+    Maze maze = shared->maze;
+
+    while(!shared->done)
+    {
+        // the calling thread counts the levels, so there is nothing to flush
+        if(worker == shared->workers)
+            stat_level(shared->frontierSize);
+
+        // EXPAND: claims chunks of the frontier until there are none left
+        size_t begin;
+        while((begin = __atomic_fetch_add(&shared->cursor, CHUNK,
+                                          __ATOMIC_RELAXED))
+              < shared->frontierSize)
+        {
+            size_t end = begin + CHUNK;
+            if(end > shared->frontierSize)
+                end = shared->frontierSize;
+
+            for(size_t i = begin; i < end; ++i)
+            {
+                uint32_t cell = shared->frontier[i];
+
+                claimNeighbor(worker, maze_east(maze, cell));
+                claimNeighbor(worker, maze_south(maze, cell));
+                claimNeighbor(worker, maze_west(maze, cell));
+                claimNeighbor(worker, maze_north(maze, cell));
+            }
+        }
+
+        // one thread lays out the next frontier once everyone is done
+        if(pthread_barrier_wait(&shared->barrier) ==
+           PTHREAD_BARRIER_SERIAL_THREAD)
+        {
+            size_t total = 0;
+            for(unsigned t = 0; t < shared->threads; ++t)
+            {
+                shared->workers[t].offset = total;
+                total += shared->workers[t].localSize;
+            }
+
+            growArray(&shared->next, &shared->nextCapacity, total);
+            shared->frontierSize = total;
+        }
+        pthread_barrier_wait(&shared->barrier);
+
+        // STITCH: every thread copies its cells into place
+        if(worker->localSize > 0)
+            memcpy(shared->next + worker->offset, worker->local,
+                   worker->localSize * sizeof(uint32_t));
+        worker->localSize = 0;
+
+        // one thread swaps the frontiers over and decides if we go on
+        if(pthread_barrier_wait(&shared->barrier) ==
+           PTHREAD_BARRIER_SERIAL_THREAD)
+        {
+            uint32_t *swap = shared->frontier;
+            size_t swapCapacity = shared->frontierCapacity;
+            shared->frontier = shared->next;
+            shared->frontierCapacity = shared->nextCapacity;
+            shared->next = swap;
+            shared->nextCapacity = swapCapacity;
+
+            shared->cursor = 0;
+            shared->done = shared->found || shared->frontierSize == 0;
+            if(!shared->done)
+                ++shared->levelSteps;
+        }
+        pthread_barrier_wait(&shared->barrier);
+    }
+
+    return NULL;
+}
+
+
+/// finds the shortest path with a BFS spread across threads
+size_t solve_parallel( Maze maze, uint32_t start, uint32_t goal,
+                       unsigned threads )
+{
+    // waste of time if we can't get in/out of the maze
+    if(bit_test(maze->walls, goal) || bit_test(maze->walls, start))
+        return 0;
+
+    // already there, it's a single step
+    if(start == goal)
+        return 1;
+
+    struct shared_s shared;
+    shared.maze = maze;
+    shared.goal = goal;
+    shared.visited = maze_createVisitedMap(maze);
+    if(shared.visited == NULL)
+    {
+        fprintf(stderr, "Unable to allocate a search of %zu words.\n",
+                maze->words);
+        exit(EXIT_FAILURE);
+    }
+    shared.found = false;
+    shared.done = false;
+    shared.cursor = 0;
+    shared.levelSteps = 1;
+    shared.threads = threads;
+
+    // the frontier starts as just the start cell (1 step into the maze)
+    shared.frontier = NULL;
+    shared.next = NULL;
+    shared.frontierCapacity = 0;
+    shared.nextCapacity = 0;
+    growArray(&shared.frontier, &shared.frontierCapacity, 1);
+    growArray(&shared.next, &shared.nextCapacity,
+              2 * (maze->rows + maze->cols));
+    shared.frontier[0] = start;
+    shared.frontierSize = 1;
+    bit_set(shared.visited, start);
+
+    // sets up every thread (the calling thread is worker 0)
+    shared.workers = calloc(threads, sizeof(struct worker_s));
+    if(shared.workers == NULL)
+    {
+        fprintf(stderr, "Unable to allocate %u search threads.\n", threads);
+        exit(EXIT_FAILURE);
+    }
+    int failed = pthread_barrier_init(&shared.barrier, NULL, threads);
+    if(failed != 0)
+    {
+        fprintf(stderr, "Unable to start search threads: %s\n",
+                strerror(failed));
+        exit(EXIT_FAILURE);
+    }
+    for(unsigned t = 0; t < threads; ++t)
+    {
+        shared.workers[t].shared = &shared;
+        // every thread is needed at the barrier, we can't go on without one
+        if(t > 0 && (failed = pthread_create(&shared.workers[t].thread, NULL,
+                                             searchLevels,
+                                             &shared.workers[t])) != 0)
+        {
+            fprintf(stderr, "Unable to start search thread: %s\n",
+                    strerror(failed));
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // searches alongside the others then waits for them to finish
+    stat_search();
+    searchLevels(&shared.workers[0]);
+    for(unsigned t = 1; t < threads; ++t)
+        pthread_join(shared.workers[t].thread, NULL);
+
+    // the goal was found while expanding the last frontier
+    size_t steps = (shared.found) ? shared.levelSteps + 1 : 0;
+
+    // tears everything down
+    pthread_barrier_destroy(&shared.barrier);
+    for(unsigned t = 0; t < threads; ++t)
+        free(shared.workers[t].local);
+    free(shared.workers);
+    free(shared.frontier);
+    free(shared.next);
+    maze_clearVisitedMap(shared.visited);
+
+    return steps;
+}
@@ -0,0 +1,240 @@
+///
+/// File: parseRow.c
+///
+/// Description: Parses a line of maze text into packed wall bits. A line is
+///              cols digits separated by single spaces, so every 2 bytes of
+///              text hold one cell: the SIMD kernels strip the separators out
+///              of 32 (or 64) bytes at a time and use movemask to turn the
+///              remaining digits straight into wall bits.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#include <stdbool.h> // boolean items
+#include "parseRow.h" // the function we need to write is in here
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h> // SSE2 and AVX2 intrinsics
+#endif
+
+
+///
+/// Function: parseTail
+///
+/// Description: Parses the columns of a line from col on, one at a time.
+///
+/// @param *line  The start of the line to parse.
+/// @param col  The first column to parse.
+/// @param cols  The number of columns in the line.
+/// @param *bits  Where the walls are written.
+/// @param word  The walls already parsed into the word col belongs to.
+///
+/// @return true if the columns were well formed; false otherwise.
+///
+static bool parseTail(const char *line,
+                      size_t col,
+                      size_t cols,
+                      uint64_t *bits,
+                      uint64_t word)
+{
+    // any bad characters seen
+    uint64_t bad = 0;
+    size_t c;
+
+    for(c = col; c < cols; ++c)
+    {
+        // '1' is a wall, '0' is open, anything else is an error
+        unsigned char digit = (unsigned char) (line[c * 2] - '0');
+        bad |= digit > 1;
+        word |= (uint64_t) (digit & 1) << (c & 63);
+
+        // every digit but the last is followed by a space
+        if(c + 1 < cols)
+            bad |= line[c * 2 + 1] != ' ';
+
+        // flushes each full word
+        if((c & 63) == 63)
+        {
+            bits[c >> 6] = word;
+            word = 0;
+        }
+    }
+
+    // flushes the partial word at the end of the line
+    if(c & 63)
+        bits[c >> 6] = word;
+
+    return !bad;
+}
+
+
+#if !defined(__SSE2__)
+
+///
+/// Function: parseRowScalar
+///
+/// Description: Parses a line one column at a time.
+///
+static bool parseRowScalar(const char *line, size_t cols, uint64_t *bits)
+{
+    return parseTail(line, 0, cols, bits, 0);
+}
+
+#else
+
+///
+/// Function: parseRowSSE2
+///
+/// Description: Parses a line 16 columns (32 bytes) at a time. The digits sit
+///              in the low byte of each 16-bit lane, so masking off the high
+///              byte and packing leaves 16 digits; shifting each up into the
+///              sign bit lets movemask gather them as 16 wall bits.
+///
+static bool parseRowSSE2(const char *line, size_t cols, uint64_t *bits)
+{
+    const __m128i zeros = _mm_set1_epi8('0'), spaces = _mm_set1_epi8(' ');
+    const __m128i lowBytes = _mm_set1_epi16(0x00ff);
+    // any digit that wasn't '0' or '1' leaves a bit other than bit 0 set here
+    __m128i badDigits = _mm_setzero_si128();
+    // every separator must be a space
+    unsigned badSpaces = 0;
+    uint64_t word = 0;
+    size_t c;
+
+    // each chunk must be followed by a separator, so the last column is left
+    for(c = 0; c + 16 < cols; c += 16)
+    {
+        __m128i lo = _mm_loadu_si128((const __m128i *) (line + c * 2));
+        __m128i hi = _mm_loadu_si128((const __m128i *) (line + c * 2 + 16));
+
+        // the separators are the odd bytes
+        badSpaces |= ~(_mm_movemask_epi8(_mm_cmpeq_epi8(lo, spaces)) &
+                       _mm_movemask_epi8(_mm_cmpeq_epi8(hi, spaces))) & 0xaaaa;
+
+        // the digits are the even bytes, as 0 or 1
+        __m128i digits = _mm_packus_epi16(
+            _mm_and_si128(_mm_sub_epi8(lo, zeros), lowBytes),
+            _mm_and_si128(_mm_sub_epi8(hi, zeros), lowBytes));
+        badDigits = _mm_or_si128(badDigits, digits);
+
+        // moves bit 0 of each byte up to bit 7 and gathers them
+        uint64_t walls = (uint16_t) _mm_movemask_epi8(
+            _mm_slli_epi16(digits, 7));
+        word |= walls << (c & 63);
+
+        // flushes each full word
+        if((c & 63) == 48)
+        {
+            bits[c >> 6] = word;
+            word = 0;
+        }
+    }
+
+    // any byte of the digits but bit 0 means a bad digit
+    badDigits = _mm_andnot_si128(_mm_set1_epi8(1), badDigits);
+    if(_mm_movemask_epi8(_mm_cmpeq_epi8(badDigits, _mm_setzero_si128()))
+       != 0xffff || badSpaces)
+        return false;
+
+    return parseTail(line, c, cols, bits, word);
+}
+
+#endif
+
+
+#if defined(__x86_64__) && defined(__GNUC__)
+
+///
+/// Function: parseRowAVX2
+///
+/// Description: Parses a line 32 columns (64 bytes) at a time. Works like the
+///              SSE2 kernel, except the pack works within 128-bit lanes so the
+///              64-bit quarters must be put back in order before the movemask.
+///
+__attribute__((target("avx2")))
+static bool parseRowAVX2(const char *line, size_t cols, uint64_t *bits)
+{
+    const __m256i zeros = _mm256_set1_epi8('0'), spaces = _mm256_set1_epi8(' ');
+    const __m256i lowBytes = _mm256_set1_epi16(0x00ff);
+    // any digit that wasn't '0' or '1' leaves a bit other than bit 0 set here
+    __m256i badDigits = _mm256_setzero_si256();
+    // every separator must be a space
+    uint32_t badSpaces = 0;
+    uint64_t word = 0;
+    size_t c;
+
+    // each chunk must be followed by a separator, so the last column is left
+    for(c = 0; c + 32 < cols; c += 32)
+    {
+        __m256i lo = _mm256_loadu_si256((const __m256i *) (line + c * 2));
+        __m256i hi = _mm256_loadu_si256((const __m256i *) (line + c * 2 + 32));
+
+        // the separators are the odd bytes
+        badSpaces |= ~((uint32_t) _mm256_movemask_epi8(
+                           _mm256_cmpeq_epi8(lo, spaces)) &
+                       (uint32_t) _mm256_movemask_epi8(
+                           _mm256_cmpeq_epi8(hi, spaces))) & 0xaaaaaaaa;
+
+        // the digits are the even bytes, as 0 or 1, put back in column order
+        __m256i digits = _mm256_permute4x64_epi64(_mm256_packus_epi16(
+            _mm256_and_si256(_mm256_sub_epi8(lo, zeros), lowBytes),
+            _mm256_and_si256(_mm256_sub_epi8(hi, zeros), lowBytes)), 0xd8);
+        badDigits = _mm256_or_si256(badDigits, digits);
+
+        // moves bit 0 of each byte up to bit 7 and gathers them
+        uint64_t walls = (uint32_t) _mm256_movemask_epi8(
+            _mm256_slli_epi16(digits, 7));
+        word |= walls << (c & 63);
+
+        // flushes each full word
+        if((c & 63) == 32)
+        {
+            bits[c >> 6] = word;
+            word = 0;
+        }
+    }
+
+    // any byte of the digits but bit 0 means a bad digit
+    badDigits = _mm256_andnot_si256(_mm256_set1_epi8(1), badDigits);
+    if(!_mm256_testz_si256(badDigits, badDigits) || badSpaces)
+        return false;
+
+    return parseTail(line, c, cols, bits, word);
+}
+
+#endif
+
+
+///
+/// Function: selectParser
+///
+/// Description: Picks the widest kernel the CPU we are running on supports.
+///
+/// @return the kernel to parse rows with.
+///
+static bool (*selectParser(void))(const char *, size_t, uint64_t *)
+{
+#if defined(__x86_64__) && defined(__GNUC__)
+    if(__builtin_cpu_supports("avx2"))
+        return parseRowAVX2;
+#endif
+#if defined(__SSE2__)
+    return parseRowSSE2;
+#else
+    return parseRowScalar;
+#endif
+}
+
+
+/// parses a row with the best kernel for this CPU
+bool parseRow(const char *line, size_t cols, uint64_t *bits)
+{
+    // the kernel is picked the first time we are called
+    static bool (*kernel)(const char *, size_t, uint64_t *) = NULL;
+
+    if(kernel == NULL)
+        kernel = selectParser();
+
+    return kernel(line, cols, bits);
+}
@@ -0,0 +1,35 @@
+///
+/// File: parseRow.h
+///
+/// Description: Parses a line of maze text into packed wall bits.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#ifndef _PARSE_ROW_H_
+#define _PARSE_ROW_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+///
+/// Function: parseRow
+///
+/// Description: Parses one line of the maze ("0 1 0 ...") into packed wall
+///              bits, checking the separators as it goes. Uses the widest SIMD
+///              kernel the CPU supports (AVX2, then SSE2), falling back to a
+///              scalar loop elsewhere.
+///
+/// @param *line  The start of the line to parse; must hold at least
+///               cols * 2 - 1 characters.
+/// @param cols  The number of columns in the line.
+/// @param *bits  Where the walls are written (bit c is column c); must hold
+///               (cols + 63) / 64 words.
+///
+/// @return true if the line was well formed; false otherwise.
+///
+bool parseRow(const char *line, size_t cols, uint64_t *bits);
+
+#endif
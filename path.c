@@ -0,0 +1,151 @@
+///
+/// File: path.c
+///
+/// Description: Finds the shortest path itself (not just its length) through a
+///              maze. The BFS records, for every cell it reaches, the direction
+///              back to the cell it was reached from as a 2-bit code, so the
+///              whole map of predecessors costs a quarter of a byte per cell.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#include <stdbool.h> // boolean items
+#include <stdio.h> // error reporting
+#include <stdlib.h> // allocation functions
+#include "solve.h" // the functions we need to write are in here
+#include "queue.h" // queue related items
+#include "stats.h" // instrumentation counters
+
+
+// the directions a parent can be in (fits in 2 bits)
+enum { EAST, SOUTH, WEST, NORTH };
+
+
+///
+/// Function: setParent
+///
+/// Description: Records the direction of a cell's parent in the packed map.
+///
+/// @param parents  The packed map of 2-bit direction codes (32 per word).
+/// @param cell  The packed index of the cell.
+/// @param dir  The direction of the parent from the cell.
+///
+static inline void setParent(uint64_t *parents, uint32_t cell, unsigned dir)
+{
+    unsigned shift = (cell & 31) * 2;
+    parents[cell >> 5] = (parents[cell >> 5] & ~((uint64_t) 3 << shift)) |
+                         ((uint64_t) dir << shift);
+}
+
+
+///
+/// Function: getParent
+///
+/// Description: Gets the packed index of a cell's parent from the packed map.
+///
+/// @param maze  The maze being searched.
+/// @param parents  The packed map of 2-bit direction codes.
+/// @param cell  The packed index of the cell.
+///
+/// @return the packed index of the parent.
+///
+static inline uint32_t getParent(Maze maze, const uint64_t *parents,
+                                 uint32_t cell)
+{
+    switch((parents[cell >> 5] >> ((cell & 31) * 2)) & 3)
+    {
+        case EAST:
+            return maze_east(maze, cell);
+        case SOUTH:
+            return maze_south(maze, cell);
+        case WEST:
+            return maze_west(maze, cell);
+        default:
+            return maze_north(maze, cell);
+    }
+}
+
+
+/// finds the shortest path with a BFS and hands back the cells on it
+size_t solve_path( Maze maze, uint32_t start, uint32_t goal, uint32_t **path )
+{
+    *path = NULL;
+
+    // waste of time if we can't get in/out of the maze
+    if(bit_test(maze->walls, goal) || bit_test(maze->walls, start))
+        return 0;
+
+    // one 2-bit code per bit of the plane; only reached cells are ever read,
+    // so the map does not need clearing
+    uint64_t *parents = malloc(maze->words * 2 * sizeof(uint64_t));
+    uint64_t *visited = maze_createVisitedMap(maze);
+    Queue q = que_create(2 * (maze->rows + maze->cols));
+    if(parents == NULL || visited == NULL || q == NULL)
+    {
+        fprintf(stderr, "Unable to allocate a search of %zu words.\n",
+                maze->words);
+        exit(EXIT_FAILURE);
+    }
+
+    que_insert(q, start);
+    bit_set(visited, start);
+
+    // plain top-down BFS; it stops as soon as the goal is reached
+    stat_search();
+    while(!que_empty(q) && !bit_test(visited, goal))
+    {
+        stat_expand(1, que_size(q));
+        uint32_t searching = que_remove(q);
+
+        // the four neighbors, and the direction back to searching from each
+        uint32_t neighbors[4] = {
+            maze_east(maze, searching),
+            maze_south(maze, searching),
+            maze_west(maze, searching),
+            maze_north(maze, searching)
+        };
+        const unsigned back[4] = { WEST, NORTH, EAST, SOUTH };
+
+        for(int i = 0; i < 4; ++i)
+            if(!bit_test(visited, neighbors[i]))
+            {
+                que_insert(q, neighbors[i]);
+                bit_set(visited, neighbors[i]);
+                setParent(parents, neighbors[i], back[i]);
+            }
+    }
+
+    size_t steps = 0;
+
+    if(bit_test(visited, goal))
+    {
+        // walks back once to count the cells on the path...
+        steps = 1;
+        for(uint32_t cell = goal; cell != start;
+            cell = getParent(maze, parents, cell))
+            ++steps;
+
+        // ...and again to fill them in, from the goal back to the start
+        *path = malloc(steps * sizeof(uint32_t));
+        if(*path == NULL)
+        {
+            fprintf(stderr, "Unable to allocate a path of %zu cells.\n",
+                    steps);
+            exit(EXIT_FAILURE);
+        }
+
+        uint32_t cell = goal;
+        for(size_t i = steps; i > 0; --i)
+        {
+            (*path)[i - 1] = cell;
+            cell = getParent(maze, parents, cell);
+        }
+    }
+
+    que_destroy(q);
+    maze_clearVisitedMap(visited);
+    free(parents);
+
+    return steps;
+}
@@ -1,34 +1,105 @@
 ///
 /// File: queue.c
 ///
-/// Description: An abstract data type for a queue module.
+/// Description: An abstract data type for a queue module. Implemented as a
+///              ring buffer of packed cell indices.
 ///
 /// @author kjb2503 : Kevin Becker
 ///
 // // // // // // // // // // // // // // // // // // // // // // // // // // //
 
+#include <stdio.h> // error reporting
 #include <stdlib.h> // malloc, free
+#include <string.h> // memcpy
 #include <stdbool.h> // boolean data members
 #include <assert.h> // used for the assert in que_destroy(1)
 #include "queue.h" // queue functions and structures
 
 
-/// creates an empty queue with comparison function pointer passed as argument
-Queue que_create()
+// the smallest ring buffer we will ever allocate
+#define QUE_MIN_CAPACITY 64
+
+
+///
+/// Function: roundCapacity
+///
+/// Description: Rounds a requested capacity up to the next power of two so
+///              that wrapping around the ring is a simple mask.
+///
+/// @param capacity  The requested capacity.
+///
+/// @return the power of two capacity to allocate.
+///
+static size_t roundCapacity(size_t capacity)
+{
+    // starts at our minimum and doubles until we are large enough
+    size_t rounded = QUE_MIN_CAPACITY;
+    while(rounded < capacity)
+        rounded <<= 1;
+
+    return rounded;
+}
+
+
+///
+/// Function: queGrow
+///
+/// Description: Doubles the capacity of a full queue, unwrapping the ring so
+///              the front of the queue lands at slot 0 of the new buffer.
+///
+/// @param queue  The queue to grow.
+///
+static void queGrow( Queue queue )
+{
+    // the new, doubled, buffer
+    size_t capacity = queue->capacity << 1;
+    uint32_t *cells = malloc(capacity * sizeof(uint32_t));
+
+    // we cannot continue the search without space for the frontier
+    if(cells == NULL)
+    {
+        fprintf(stderr, "Unable to grow queue to %zu cells.\n", capacity);
+        exit(EXIT_FAILURE);
+    }
+
+    // copies the two halves of the ring (front to end, then start to back)
+    size_t firstPart = queue->capacity - queue->head;
+    memcpy(cells, queue->cells + queue->head, firstPart * sizeof(uint32_t));
+    memcpy(cells + firstPart, queue->cells, queue->head * sizeof(uint32_t));
+
+    // swaps in our new buffer
+    free(queue->cells);
+    queue->cells = cells;
+    queue->capacity = capacity;
+    queue->head = 0;
+}
+
+
+/// creates an empty queue able to hold capacity cells before growing
+Queue que_create( size_t capacity )
 {
     // pointer to a new queue (set to NULL for now)
     Queue queue = NULL;
     // allocates enough space for our queue
     queue = malloc(sizeof(struct queue_s));
-    
+
     // if we encounter an error in creating our queue
     if(queue == NULL)
         return queue;
 
-    // sets our first and last nodes to null
-    queue->firstNode = NULL;
-    queue->lastNode = NULL;
+    // allocates the ring buffer up front so inserts never allocate
+    queue->capacity = roundCapacity(capacity);
+    queue->cells = malloc(queue->capacity * sizeof(uint32_t));
+
+    // if we could not get the buffer we cannot have a queue either
+    if(queue->cells == NULL)
+    {
+        free(queue);
+        return NULL;
+    }
+
     // current size is 0
+    queue->head = 0;
     queue->size = 0;
 
     // returns our new, empty queue
@@ -36,38 +107,15 @@ Queue que_create()
 }
 
 
-/// clears a queue of all data, freeing all blocks of allocated memory
+/// clears a queue of all data; the ring buffer is kept for reuse
 void que_clear( Queue queue )
 {
-    // we only want to do this if we have an actual queue and it's not empty
-    if (queue != NULL && !que_empty(queue))
+    // we only want to do this if we have an actual queue
+    if (queue != NULL)
     {
-        // when we get here we are guaranteed that there is a firstNode node
-        // declares two nodes: one definitely has data, the other might not
-        QNode curNode = queue->firstNode, nextNode = curNode->behind;
-
-        // keep freeing until our nextNode is NULL
-        while (nextNode != NULL)
-        {
-            // frees our current node
-            free(curNode);
-            // sets our current node to next
-            curNode = nextNode;
-            // sets next node to the new current's behind node
-            nextNode = curNode->behind;
-        }
-
-        // clears the last node from heap
-        // this is required since we don't free the last node in the loop
-        free(curNode);
-        // sets our curNode to NULL (nextNode is already NULL)
-        curNode = NULL;
-
-        // last thing we do is set our queue's number polled
-        // to 0 and our first nodes to NULL, it's now empty
+        // nothing to free, the cells live in the ring itself
+        queue->head = 0;
         queue->size = 0;
-        queue->firstNode = NULL;
-        queue->lastNode = NULL;
     }
 }
 
@@ -75,14 +123,18 @@ void que_clear( Queue queue )
 /// destroys the queue by clearing all data and freeing the queue from memory
 void que_destroy( Queue queue )
 {
+    // nothing to do for a queue that was never made
+    if(queue == NULL)
+        return;
+
     // clears all the data out of the queue
-    // why implement the same thing twice?
     que_clear(queue);
 
     // in order to free our queue we need to have an empty queue
     assert(que_empty(queue));
 
-    // frees our queue (only difference for destroy function)
+    // frees our ring buffer and then our queue
+    free(queue->cells);
     free(queue);
 
     // sets queue to NULL
@@ -90,66 +142,46 @@ void que_destroy( Queue queue )
 }
 
 
-/// inserts our coordinates
-void que_insert( Queue queue, size_t row, size_t col, size_t steps )
+/// inserts a cell at the back of the queue
+void que_insert( Queue queue, uint32_t cell )
 {
-    // creates a new node with data of data
-    QNode newNode = NULL;
-    // allocates enough space for our QNode on the heap
-    newNode = malloc(sizeof(struct qnode_s));
-    // sets our data in place
-    newNode->row = row;
-    newNode->col = col;
-    newNode->steps = steps;
-    // our new QNode might have something behind it, but we don't know
-    newNode->behind = NULL;
-
-    // if we have an empty queue we can immediately just put the node in
-    // (no comparisons are needed)
-    if(queue->size == 0)
-    {
-        // sets both the first and last element to new node
-        queue->firstNode = newNode;
-        queue->lastNode = newNode;
+    // makes room if the ring is full
+    if(queue->size == queue->capacity)
+        queGrow(queue);
 
-        // checks to make sure we have the
-        assert(queue->lastNode == newNode);
-    }
-    // FIFO
-    else
-    {
-        // last node's next member is set to our new node
-        queue->lastNode->behind = newNode;
-        // lastNode of queue set to our new node
-        queue->lastNode = newNode;
-        // checks to make sure we have properly done this
-        assert(queue->lastNode == newNode);
-    }
+    // the back of the ring is size slots after the head (wrapping around)
+    queue->cells[(queue->head + queue->size) & (queue->capacity - 1)] = cell;
 
     // adds one to the size of the queue (we just added one in)
     queue->size++;
 }
 
 
-/// removes the first element in our queue and frees the memory
-QNode que_remove( Queue queue )
+/// removes the first element in our queue and returns it
+uint32_t que_remove( Queue queue )
 {
-    // ( lastNode ) QNode -> QNode -> QNode -> QNode ( firstNode )
-    // pulls in our firstNode node
-    QNode firstNode = queue->firstNode;
-    
-    // changes our firstNode node to be the behind member
-    queue->firstNode = firstNode->behind;
-    
-    // if we're on our last node (size will be 0 next, we need to keep track of
-    // that fact and set our lastNode to NULL)
-    if (queue->size == 1)
-        queue->lastNode = NULL;
-    // subtracts one from the size
+    // we can't remove from an empty queue
+    assert(!que_empty(queue));
+
+    // pulls in our front cell
+    uint32_t cell = queue->cells[queue->head];
+
+    // advances the head (wrapping around) and subtracts one from the size
+    queue->head = (queue->head + 1) & (queue->capacity - 1);
     queue->size--;
 
     // returns the value we just removed
-    return firstNode;
+    return cell;
+}
+
+
+/// looks at a cell without removing it
+uint32_t que_peek( Queue queue, size_t index )
+{
+    // we can't look past the back of the queue
+    assert(index < queue->size);
+
+    return queue->cells[(queue->head + index) & (queue->capacity - 1)];
 }
 
 
@@ -158,3 +190,10 @@ bool que_empty( Queue queue )
 {
     return (queue->size == 0) ? true : false;
 }
+
+
+/// returns the number of cells in the queue
+size_t que_size( Queue queue )
+{
+    return queue->size;
+}
@@ -11,29 +11,33 @@
 #define _QUEUE_H_
 
 #include <stdbool.h>
-
-// our storage unit
-typedef struct qnode_s{
-    struct qnode_s *behind;
-    size_t row, col, steps; // the x and y coordinates and steps to location
-} * QNode;
+#include <stddef.h>
+#include <stdint.h>
 
 // Queue structure
+// NOTE: the queue is a ring buffer of packed 32-bit cell indices; it is grown
+//       geometrically on the rare occasion the frontier outgrows it, so no
+//       allocation happens per inserted cell
 typedef struct queue_s{
-    // the front of our queue (can be NULL if empty queue)
-    QNode firstNode;
-    // the back of our queue (can be NULL if empty queue)
-    QNode lastNode;
+    // the ring buffer itself
+    uint32_t *cells;
+    // the number of slots in the ring buffer (always a power of two)
+    size_t capacity;
+    // the index of the front of our queue
+    size_t head;
     // the size of our queue
     size_t size;
 } * Queue;
 
-/// 
+///
 /// Create a Queue routine.
 ///
+/// @param capacity  the expected number of cells the queue will hold at once;
+///                  rounded up to a power of two.
+///
 /// @return a Queue instance, or NULL if the allocation fails.
 ///
-Queue que_create();
+Queue que_create( size_t capacity );
 
 ///
 /// Tear down and deallocate the supplied Queue.
@@ -50,35 +54,27 @@ void que_destroy( Queue queue );
 void que_clear( Queue queue );
 
 ///
-/// Insert the specified data into the Queue in the appropriate place.
-///
-/// Uses the queue's comparison function to determine the appropriate
-/// place for the insertion.
+/// Insert the specified cell at the back of the Queue.
 ///
 /// @param queue the Queue into which the value is to be inserted.
-/// @param row  the row of the node to be inserted.
-/// @param col  the col of the node to be inserted.
-/// @param steps  the number of steps to get to the node.
-/// @exception If the value cannot be inserted into the queue for
-///     whatever reason (usually implementation-dependent), the program
-///     should terminate with an error message.  This can be done by
-///     printing an appropriate message to the standard error output and
-///     then exiting with EXIT_FAILURE, or by having an assert() fail.
-///
-void que_insert( Queue queue, size_t row, size_t col, size_t steps);
+/// @param cell  the packed index of the cell to be inserted.
+/// @exception If the queue is full and cannot be grown, the program
+///     terminates with an error message printed to the standard error
+///     output and an exit status of EXIT_FAILURE.
+///
+void que_insert( Queue queue, uint32_t cell );
 
 ///
 /// Remove and return the first element from the Queue.
 ///
 /// @param queue the Queue to be manipulated.
-/// @return the value that was removed from the queue. INFO ABOUT RETURN: nodes
-///         are stored on the heap so you MUST free them after done using it.
+/// @return the cell index that was removed from the queue.
 /// @exception If the queue is empty, the program should terminate
 ///     with an error message.  This can be done by printing an
 ///     appropriate message to the standard error output and then
 ///     exiting with EXIT_FAILURE, or by having an assert() fail.
 ///
-QNode que_remove( Queue queue );
+uint32_t que_remove( Queue queue );
 
 ///
 /// Indicate whether or not the supplied Queue is empty.
@@ -88,5 +84,23 @@ QNode que_remove( Queue queue );
 ///
 bool que_empty( Queue queue );
 
+///
+/// Look at a cell in the Queue without removing it.
+///
+/// @param queue the Queue to look in.
+/// @param index how far from the front of the queue the cell is (0 is the
+///     front); must be less than the size of the queue.
+/// @return the cell index at that position.
+///
+uint32_t que_peek( Queue queue, size_t index );
+
+///
+/// Get the number of cells currently held in the Queue.
+///
+/// @param the Queue to be measured.
+/// @return the number of cells in the queue.
+///
+size_t que_size( Queue queue );
+
 #endif
 
@@ -0,0 +1,127 @@
+///
+/// File: renderRow.c
+///
+/// Description: Renders a row of packed wall bits as maze text, the reverse of
+///              parseRow. Every cell is 2 bytes of text, so the kernels turn
+///              the walls into a character per cell a byte of walls at a time
+///              and interleave them with the spaces.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#include <stdbool.h> // boolean items
+#include <string.h> // memcpy
+#include "renderRow.h" // the function we need to write is in here
+
+#if defined(__SSE2__)
+#include <emmintrin.h> // SSE2 intrinsics
+#endif
+
+
+///
+/// Function: wallWord
+///
+/// Description: Gets the walls of 64 columns of a row, starting at a column
+///              that is a multiple of 64 (the row is one bit east of the
+///              sentinel, so each word is put together from two).
+///
+static inline uint64_t wallWord(const uint64_t *row, size_t col)
+{
+    return (row[col / 64] >> 1) | (row[col / 64 + 1] << 63);
+}
+
+
+#if !defined(__SSE2__)
+
+///
+/// Function: renderRowScalar
+///
+/// Description: Renders a row 8 columns at a time from a table holding the 16
+///              characters every byte of walls turns into. The table is made
+///              again only if the characters change.
+///
+static void renderRowScalar(const uint64_t *row, size_t cols, char wall,
+                            char open, char *line)
+{
+    static char table[256][16];
+    static char tableWall = 0, tableOpen = 0;
+    static bool built = false;
+
+    if(!built || tableWall != wall || tableOpen != open)
+    {
+        for(int b = 0; b < 256; ++b)
+            for(int i = 0; i < 8; ++i)
+            {
+                table[b][2 * i] = ((b >> i) & 1) ? wall : open;
+                table[b][2 * i + 1] = ' ';
+            }
+        tableWall = wall;
+        tableOpen = open;
+        built = true;
+    }
+
+    for(size_t c = 0; c < cols; c += 64)
+    {
+        uint64_t word = wallWord(row, c);
+        for(size_t b = 0; b < 8 && c + b * 8 < cols; ++b)
+            memcpy(line + (c + b * 8) * 2, table[(word >> (b * 8)) & 0xff], 16);
+    }
+}
+
+#else
+
+///
+/// Function: renderRowSSE2
+///
+/// Description: Renders a row 16 columns (32 bytes) at a time. Each byte of
+///              walls is copied across 8 bytes and tested against a byte with
+///              one bit set per lane, which leaves all ones in the lanes of the
+///              walls to pick the characters with; unpacking with spaces then
+///              puts the separators in.
+///
+static void renderRowSSE2(const uint64_t *row, size_t cols, char wall,
+                          char open, char *line)
+{
+    const __m128i bit = _mm_set1_epi64x((long long) 0x8040201008040201ULL);
+    const __m128i opens = _mm_set1_epi8(open);
+    const __m128i flips = _mm_set1_epi8((char) (wall ^ open));
+    const __m128i spaces = _mm_set1_epi8(' ');
+
+    for(size_t c = 0; c < cols; c += 64)
+    {
+        uint64_t word = wallWord(row, c);
+        for(size_t h = 0; h < 4 && c + h * 16 < cols; ++h)
+        {
+            uint64_t lo = (word >> (h * 16)) & 0xff,
+                     hi = (word >> (h * 16 + 8)) & 0xff;
+
+            // copies each byte across its half, then finds the walls
+            __m128i spread = _mm_set_epi64x(
+                (long long) (hi * 0x0101010101010101ULL),
+                (long long) (lo * 0x0101010101010101ULL));
+            __m128i isWall = _mm_cmpeq_epi8(_mm_and_si128(spread, bit), bit);
+            __m128i cells = _mm_xor_si128(opens,
+                                          _mm_and_si128(isWall, flips));
+
+            char *at = line + (c + h * 16) * 2;
+            _mm_storeu_si128((__m128i *) at, _mm_unpacklo_epi8(cells, spaces));
+            _mm_storeu_si128((__m128i *) (at + 16),
+                             _mm_unpackhi_epi8(cells, spaces));
+        }
+    }
+}
+
+#endif
+
+
+/// renders a row with the best kernel for this CPU
+void renderRow(const uint64_t *row, size_t cols, char wall, char open,
+               char *line)
+{
+#if defined(__SSE2__)
+    renderRowSSE2(row, cols, wall, open, line);
+#else
+    renderRowScalar(row, cols, wall, open, line);
+#endif
+}
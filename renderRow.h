@@ -0,0 +1,39 @@
+///
+/// File: renderRow.h
+///
+/// Description: Renders a row of packed wall bits as maze text.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#ifndef _RENDER_ROW_H_
+#define _RENDER_ROW_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// the most bytes renderRow may write past the end of a row
+#define RENDER_SLACK 32
+
+///
+/// Function: renderRow
+///
+/// Description: Renders one row of the maze as cols characters, each followed
+///              by a space (wall for a wall, open for an open cell). Uses an
+///              SSE2 kernel where the CPU has one, falling back to a table of
+///              every byte of walls elsewhere.
+///
+/// @param *row  The padded row of the wall plane, as a Maze keeps it (column
+///              c at bit c + 1); the word after the row is read too, so the
+///              row must not be the last of its plane.
+/// @param cols  The number of columns in the row.
+/// @param wall  The character a wall is drawn as.
+/// @param open  The character an open cell is drawn as.
+/// @param *line  Where the text is written; must hold cols * 2 +
+///               RENDER_SLACK characters (anything past cols * 2 is scratch).
+///
+void renderRow(const uint64_t *row, size_t cols, char wall, char open,
+               char *line);
+
+#endif
@@ -0,0 +1,921 @@
+///
+/// File: server.c
+///
+/// Description: The server mode. Mazes are loaded once, by name, and kept.
+///              The main thread polls the listening socket and every idle
+///              connection; a connection with a request waiting is queued for
+///              a pool of worker threads, and the worker that takes it answers
+///              that one request and hands it back to be polled again. So a
+///              worker is only ever tied up by a request, never by a client
+///              that is connected but quiet, and a client that stops halfway
+///              through a frame is dropped after REQUEST_TIMEOUT seconds.
+///              Each worker keeps its own solver context and request/reply
+///              buffers between requests (they only ever grow, when a bigger
+///              maze or message turns up), so a request is answered without
+///              allocating anything.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#define _GNU_SOURCE
+#include <errno.h> // EINTR
+#include <fcntl.h> // non-blocking listener and wake up pipe
+#include <poll.h> // waiting on every idle connection at once
+#include <pthread.h> // threads, mutexes and condition variables
+#include <stdarg.h> // replies are printf-like
+#include <stdio.h> // printing
+#include <stdlib.h> // allocation functions
+#include <string.h> // string functions
+#include <unistd.h> // close, unlink
+#include <arpa/inet.h> // htonl, ntohl
+#include <sys/socket.h> // sockets
+#include <sys/time.h> // struct timeval, for timeouts
+#include <sys/un.h> // Unix socket addresses
+#include "server.h" // the function we need to write is in here
+#include "fileRead.h" // reading in mazes
+#include "solve.h" // the search engines
+#include "batch.h" // answering batches of queries grouped by source
+#include "stats.h" // instrumentation counters
+
+
+// the largest frame we will accept
+#define MAX_FRAME (64u << 20)
+
+// the most connections open at once (more are turned away); kept well under
+// the usual limit of 1024 open files
+#define MAX_CONNECTIONS 512
+
+// the seconds a client may take to send the rest of a request, or to take
+// the reply, before it is dropped
+#define REQUEST_TIMEOUT 2
+
+
+// one named maze
+struct entry_s{
+    char *name;
+    Maze maze;
+    // the number of requests using the maze right now
+    unsigned users;
+    // whether the maze can still be found by name (once it is replaced or
+    // unloaded, the last request using it frees it)
+    bool listed;
+    struct entry_s *next;
+};
+
+// the state shared by every thread of the server
+struct server_s{
+    // the socket connections arrive on
+    int listener;
+    // the pipe the workers wake the polling thread with (read end first)
+    int wake[2];
+    // the connections with a request waiting for a worker (a ring), the ones
+    // the workers have handed back to be polled, the number open in all, and
+    // whether we're done
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    int pending[MAX_CONNECTIONS];
+    size_t head, count;
+    int returned[MAX_CONNECTIONS];
+    size_t returnedCount, connections;
+    bool stopping;
+    // the named mazes
+    pthread_mutex_t mazeLock;
+    struct entry_s *mazes;
+    // every worker thread
+    struct worker_s *workers;
+    unsigned threads;
+};
+
+// the state owned by one worker thread
+struct worker_s{
+    pthread_t thread;
+    // the server this thread works for
+    struct server_s *server;
+    // the working space of a search (made for the first maze searched)
+    SolverContext ctx;
+    // the working space of a batch of queries
+    Batcher batcher;
+    // the request being answered (always NUL terminated)
+    char *request;
+    size_t requestCapacity;
+    // the reply being built, and whether it outgrew the memory there was
+    // for it
+    char *reply;
+    size_t replySize, replyCapacity;
+    bool replyLost;
+};
+
+
+///
+/// Function: acquireMaze
+///
+/// Description: Finds a maze by name and marks it as in use.
+///
+/// @param *server  The server.
+/// @param *name  The name of the maze.
+///
+/// @return the maze's entry (to be released with releaseMaze), or NULL if
+///         there is no maze by that name.
+///
+static struct entry_s * acquireMaze(struct server_s *server, const char *name)
+{
+    pthread_mutex_lock(&server->mazeLock);
+
+    struct entry_s *entry = server->mazes;
+    while(entry != NULL && strcmp(entry->name, name) != 0)
+        entry = entry->next;
+    if(entry != NULL)
+        ++entry->users;
+
+    pthread_mutex_unlock(&server->mazeLock);
+    return entry;
+}
+
+
+///
+/// Function: freeEntry
+///
+/// Description: Frees a maze entry and its maze.
+///
+static void freeEntry(struct entry_s *entry)
+{
+    maze_destroy(entry->maze);
+    free(entry->name);
+    free(entry);
+}
+
+
+///
+/// Function: releaseMaze
+///
+/// Description: Marks a maze as no longer in use by a request, freeing it if
+///              it has since been unloaded and this was its last user.
+///
+/// @param *server  The server.
+/// @param *entry  The entry from acquireMaze.
+///
+static void releaseMaze(struct server_s *server, struct entry_s *entry)
+{
+    pthread_mutex_lock(&server->mazeLock);
+    bool last = (--entry->users == 0 && !entry->listed);
+    pthread_mutex_unlock(&server->mazeLock);
+
+    if(last)
+        freeEntry(entry);
+}
+
+
+///
+/// Function: unlistMaze
+///
+/// Description: Takes a maze out of the list of names; it is freed now if no
+///              request is using it, or by the last one that is. The maze
+///              lock must be held.
+///
+/// @param *server  The server.
+/// @param *name  The name of the maze.
+///
+/// @return true if there was a maze by that name.
+///
+static bool unlistMaze(struct server_s *server, const char *name)
+{
+    for(struct entry_s **link = &server->mazes; *link != NULL;
+        link = &(*link)->next)
+        if(strcmp((*link)->name, name) == 0)
+        {
+            struct entry_s *entry = *link;
+            *link = entry->next;
+            entry->listed = false;
+            if(entry->users == 0)
+                freeEntry(entry);
+            return true;
+        }
+
+    return false;
+}
+
+
+///
+/// Function: loadMaze
+///
+/// Description: Loads a maze from a file and lists it under a name.
+///
+/// @param *server  The server.
+/// @param *name  The name to list it under.
+/// @param *path  The file to load it from.
+///
+/// @return true if the maze was loaded.
+///
+static bool loadMaze(struct server_s *server, const char *name,
+                     const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if(file == NULL)
+        return false;
+
+    // the slow part happens before the lock is taken
+    Maze maze = getMaze(file);
+    fclose(file);
+
+    struct entry_s *entry = (maze != NULL) ? malloc(sizeof(*entry)) : NULL;
+    char *copy = (entry != NULL) ? strdup(name) : NULL;
+    if(copy == NULL)
+    {
+        free(entry);
+        maze_destroy(maze);
+        return false;
+    }
+
+    entry->name = copy;
+    entry->maze = maze;
+    entry->users = 0;
+    entry->listed = true;
+
+    pthread_mutex_lock(&server->mazeLock);
+    unlistMaze(server, name);
+    entry->next = server->mazes;
+    server->mazes = entry;
+    pthread_mutex_unlock(&server->mazeLock);
+
+    return true;
+}
+
+
+///
+/// Function: reply
+///
+/// Description: Adds a printf-style line to the reply being built. If there
+///              is no memory to grow it with, the reply is marked lost (and
+///              the rest of its lines are dropped).
+///
+/// @param *worker  The worker building the reply.
+/// @param *format  The format of the line.
+///
+static void reply(struct worker_s *worker, const char *format, ...)
+{
+    while(!worker->replyLost)
+    {
+        va_list args;
+        va_start(args, format);
+        size_t room = worker->replyCapacity - worker->replySize;
+        int length = vsnprintf(worker->reply + worker->replySize, room,
+                               format, args);
+        va_end(args);
+
+        if(length < 0)
+            return;
+        if((size_t) length < room)
+        {
+            worker->replySize += (size_t) length;
+            return;
+        }
+
+        // the buffer only ever grows, so this soon stops happening
+        size_t capacity = worker->replyCapacity * 2;
+        char *bigger = realloc(worker->reply, capacity);
+        if(bigger == NULL)
+        {
+            worker->replyLost = true;
+            return;
+        }
+        worker->reply = bigger;
+        worker->replyCapacity = capacity;
+    }
+}
+
+
+///
+/// Function: workerContext
+///
+/// Description: Gets the solver context of a worker, making it for the first
+///              maze it searches (after that, it grows as it needs to).
+///
+/// @param *worker  The worker.
+/// @param maze  The maze about to be searched.
+///
+/// @return the context.
+/// @exception If the context cannot be had, the program terminates with an
+///     error message printed to the standard error output and an exit status
+///     of EXIT_FAILURE.
+///
+static SolverContext workerContext(struct worker_s *worker, Maze maze)
+{
+    if(worker->ctx == NULL && (worker->ctx = ctx_create(maze)) == NULL)
+    {
+        fprintf(stderr, "Unable to allocate a search of %zu words.\n",
+                maze->words);
+        exit(EXIT_FAILURE);
+    }
+
+    return worker->ctx;
+}
+
+
+///
+/// Function: replySteps
+///
+/// Description: Adds the answer to a query to the reply.
+///
+/// @param *worker  The worker building the reply.
+/// @param steps  The steps of the shortest path (0 if there is none).
+///
+static void replySteps(struct worker_s *worker, size_t steps)
+{
+    if(steps > 0)
+        reply(worker, "Solution in %zu steps.\n", steps);
+    else
+        reply(worker, "No solution.\n");
+}
+
+
+///
+/// Function: answerQuery
+///
+/// Description: Answers one "r1 c1 r2 c2" query (or entrance to exit, if the
+///              text is empty) into the reply.
+///
+/// @param *worker  The worker answering.
+/// @param maze  The maze the query is about.
+/// @param *text  The text of the query.
+///
+static void answerQuery(struct worker_s *worker, Maze maze, const char *text)
+{
+    size_t r1 = 0, c1 = 0, r2 = maze->rows - 1, c2 = maze->cols - 1;
+    int used = 0;
+
+    text += strspn(text, " \t\r");
+    if(*text != '\0' &&
+       (sscanf(text, "%zu %zu %zu %zu %n", &r1, &c1, &r2, &c2, &used) != 4 ||
+        text[used] != '\0' || r1 >= maze->rows || r2 >= maze->rows ||
+        c1 >= maze->cols || c2 >= maze->cols))
+    {
+        reply(worker, "Invalid query.\n");
+        return;
+    }
+
+    // the context grows if this maze is bigger than the others it has seen
+    size_t steps = solve_bfsWith(workerContext(worker, maze), maze,
+                                 maze_cell(maze, r1, c1),
+                                 maze_cell(maze, r2, c2));
+    replySteps(worker, steps);
+}
+
+
+///
+/// Function: answerBatch
+///
+/// Description: Answers every "r1 c1 r2 c2" line of some text into the reply,
+///              grouped by source just as -q answers them (found in batch.c).
+///
+/// @param *worker  The worker answering.
+/// @param maze  The maze the queries are about.
+/// @param *text  The queries, one to a line.
+///
+static void answerBatch(struct worker_s *worker, Maze maze, char *text)
+{
+    size_t count;
+    const size_t *steps = batch_answerLines(worker->batcher,
+                                            workerContext(worker, maze),
+                                            maze, text, &count);
+    if(steps == NULL)
+    {
+        reply(worker, "Error: unable to allocate the batch.\n");
+        return;
+    }
+
+    for(size_t i = 0; i < count; ++i)
+        if(steps[i] == BATCH_INVALID)
+            reply(worker, "Invalid query.\n");
+        else
+            replySteps(worker, steps[i]);
+}
+
+
+///
+/// Function: nextWord
+///
+/// Description: Splits the next word off the front of some text.
+///
+/// @param **text  The text; it is moved past the word (and the one character
+///                after it, which becomes the word's terminator).
+///
+/// @return the word, or NULL if the text has no more words.
+///
+static char * nextWord(char **text)
+{
+    char *word = *text + strspn(*text, " \t\r");
+    if(*word == '\0')
+    {
+        *text = word;
+        return NULL;
+    }
+
+    char *end = word + strcspn(word, " \t\r");
+    *text = (*end != '\0') ? end + 1 : end;
+    *end = '\0';
+
+    return word;
+}
+
+
+///
+/// Function: answerRequest
+///
+/// Description: Works out the reply to a request.
+///
+/// @param *worker  The worker answering; the request is in its buffer.
+///
+/// @return true if the request was to shut down.
+///
+static bool answerRequest(struct worker_s *worker)
+{
+    struct server_s *server = worker->server;
+
+    // splits the command line from the lines after it
+    char *line = worker->request, *rest = strchr(line, '\n');
+    if(rest != NULL)
+        *rest++ = '\0';
+    else
+        rest = line + strlen(line);
+
+    char *command = nextWord(&line);
+    char *name = nextWord(&line);
+
+    worker->replySize = 0;
+    worker->reply[0] = '\0';
+    worker->replyLost = false;
+
+    if(command == NULL)
+        reply(worker, "Error: empty request.\n");
+    else if(strcmp(command, "shutdown") == 0)
+    {
+        reply(worker, "OK.\n");
+        return true;
+    }
+    else if(strcmp(command, "load") != 0 && strcmp(command, "unload") != 0 &&
+            strcmp(command, "solve") != 0 && strcmp(command, "batch") != 0)
+        reply(worker, "Error: unknown command %s.\n", command);
+    else if(name == NULL)
+        reply(worker, "Error: %s needs a maze name.\n", command);
+    else if(strcmp(command, "load") == 0)
+    {
+        // the path is the rest of the line, spaces and all
+        char *path = line + strspn(line, " \t");
+        path[strcspn(path, "\r")] = '\0';
+        if(*path == '\0')
+            reply(worker, "Error: load needs a path.\n");
+        else if(loadMaze(server, name, path))
+            reply(worker, "OK.\n");
+        else
+            reply(worker, "Error: unable to load %s.\n", path);
+    }
+    else if(strcmp(command, "unload") == 0)
+    {
+        pthread_mutex_lock(&server->mazeLock);
+        bool found = unlistMaze(server, name);
+        pthread_mutex_unlock(&server->mazeLock);
+
+        if(found)
+            reply(worker, "OK.\n");
+        else
+            reply(worker, "Error: no maze named %s.\n", name);
+    }
+    else
+    {
+        // solve or batch
+        struct entry_s *entry = acquireMaze(server, name);
+        if(entry == NULL)
+            reply(worker, "Error: no maze named %s.\n", name);
+        else if(command[0] == 's')
+        {
+            answerQuery(worker, entry->maze, line);
+            releaseMaze(server, entry);
+        }
+        else
+        {
+            // one answer for every non-blank line after the command
+            answerBatch(worker, entry->maze, rest);
+            releaseMaze(server, entry);
+        }
+    }
+
+    return false;
+}
+
+
+///
+/// Function: transfer
+///
+/// Description: Sends or receives exactly some number of bytes.
+///
+/// @param fd  The connection.
+/// @param *buffer  The bytes.
+/// @param length  The number of bytes.
+/// @param sending  Whether to send (true) or receive (false).
+///
+/// @return true if every byte was moved; false if the connection ended.
+///
+static bool transfer(int fd, void *buffer, size_t length, bool sending)
+{
+    char *bytes = buffer;
+
+    while(length > 0)
+    {
+        ssize_t moved = (sending)
+            ? send(fd, bytes, length, MSG_NOSIGNAL)
+            : recv(fd, bytes, length, 0);
+
+        if(moved < 0 && errno == EINTR)
+            continue;
+        if(moved <= 0)
+            return false;
+
+        bytes += moved;
+        length -= (size_t) moved;
+    }
+
+    return true;
+}
+
+
+///
+/// Function: wakePoller
+///
+/// Description: Wakes the polling thread, to take back connections or to see
+///              that the server is stopping.
+///
+/// @param *server  The server.
+///
+static void wakePoller(struct server_s *server)
+{
+    // if the pipe is full the poller is already due to wake
+    char byte = 0;
+    while(write(server->wake[1], &byte, 1) < 0 && errno == EINTR)
+        ;
+}
+
+
+///
+/// Function: serveRequest
+///
+/// Description: Answers the one request waiting on a connection.
+///
+/// @param *worker  The worker serving the connection.
+/// @param fd  The connection.
+///
+/// @return true if the connection is still good for another request; false
+///         if it ended, broke a rule or timed out (or asked us to stop).
+///
+static bool serveRequest(struct worker_s *worker, int fd)
+{
+    struct server_s *server = worker->server;
+    uint32_t length;
+
+    if(!transfer(fd, &length, sizeof(length), false))
+        return false;
+
+    length = ntohl(length);
+    if(length > MAX_FRAME)
+        return false;
+
+    // the buffer only ever grows, so this soon stops happening
+    if(length + 1 > worker->requestCapacity)
+    {
+        char *bigger = realloc(worker->request, length + 1);
+        if(bigger == NULL)
+            return false;
+        worker->request = bigger;
+        worker->requestCapacity = length + 1;
+    }
+
+    if(!transfer(fd, worker->request, length, false))
+        return false;
+    worker->request[length] = '\0';
+
+    bool stop = answerRequest(worker);
+
+    // a reply too big to be built is swapped for an error (which always fits
+    // in the buffer's first size), so the server can go on
+    if(worker->replyLost)
+        worker->replySize = (size_t) snprintf(worker->reply,
+                                              worker->replyCapacity,
+                                              "Error: reply too large.\n");
+
+    uint32_t replyLength = htonl((uint32_t) worker->replySize);
+    if(!transfer(fd, &replyLength, sizeof(replyLength), true) ||
+       !transfer(fd, worker->reply, worker->replySize, true))
+        return false;
+
+    // wakes the polling thread so it can stop
+    if(stop)
+    {
+        pthread_mutex_lock(&server->lock);
+        server->stopping = true;
+        pthread_mutex_unlock(&server->lock);
+        wakePoller(server);
+        return false;
+    }
+
+    return true;
+}
+
+
+///
+/// Function: work
+///
+/// Description: The loop every worker thread runs, answering one request at a
+///              time until the server stops.
+///
+/// @param *arg  The worker_s of this thread.
+///
+/// @return NULL
+///
+static void * work(void *arg)
+{
+    struct worker_s *worker = arg;
+    struct server_s *server = worker->server;
+
+    for(;;)
+    {
+        pthread_mutex_lock(&server->lock);
+        while(server->count == 0 && !server->stopping)
+            pthread_cond_wait(&server->ready, &server->lock);
+
+        // the connections still waiting are closed by the polling thread
+        if(server->stopping)
+        {
+            pthread_mutex_unlock(&server->lock);
+            break;
+        }
+
+        int fd = server->pending[server->head];
+        server->head = (server->head + 1) % MAX_CONNECTIONS;
+        --server->count;
+        pthread_mutex_unlock(&server->lock);
+
+        // hands the connection back to be polled for its next request, or
+        // closes it
+        bool keep = serveRequest(worker, fd);
+        pthread_mutex_lock(&server->lock);
+        if(keep && !server->stopping)
+            server->returned[server->returnedCount++] = fd;
+        else
+        {
+            close(fd);
+            --server->connections;
+            keep = false;
+        }
+        pthread_mutex_unlock(&server->lock);
+        if(keep)
+            wakePoller(server);
+    }
+
+    // hands this thread's counts over before it exits
+    stat_flush();
+
+    return NULL;
+}
+
+
+///
+/// Function: openListener
+///
+/// Description: Creates the Unix socket the server listens on.
+///
+/// @param *path  The path of the socket.
+///
+/// @return the socket, or -1 if it couldn't be made (the reason is printed).
+///
+static int openListener(const char *path)
+{
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+
+    if(strlen(path) >= sizeof(address.sun_path))
+    {
+        fprintf(stderr, "Socket path too long: %s\n", path);
+        return -1;
+    }
+    strcpy(address.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd < 0 ||
+       bind(fd, (struct sockaddr *) &address, sizeof(address)) != 0 ||
+       listen(fd, SOMAXCONN) != 0)
+    {
+        perror("Error opening socket");
+        if(fd >= 0)
+            close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+
+///
+/// Function: setTimeouts
+///
+/// Description: Limits how long a worker waits on a connection for the rest
+///              of a request, or for room to send the reply.
+///
+/// @param fd  The connection.
+///
+static void setTimeouts(int fd)
+{
+    struct timeval limit = { .tv_sec = REQUEST_TIMEOUT, .tv_usec = 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &limit, sizeof(limit));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &limit, sizeof(limit));
+}
+
+
+/// serves requests until told to shut down
+bool server_run( const char *path, unsigned threads )
+{
+    struct server_s server;
+    memset(&server, 0, sizeof(server));
+    server.threads = threads;
+
+    server.listener = openListener(path);
+    if(server.listener < 0)
+        return false;
+
+    // the poller only accepts once the listener says a client is there, but
+    // that client may be gone by then, so accepting must not wait
+    if(fcntl(server.listener, F_SETFL, O_NONBLOCK) != 0 ||
+       pipe2(server.wake, O_NONBLOCK | O_CLOEXEC) != 0)
+    {
+        perror("Error opening socket");
+        close(server.listener);
+        unlink(path);
+        return false;
+    }
+
+    pthread_mutex_init(&server.lock, NULL);
+    pthread_cond_init(&server.ready, NULL);
+    pthread_mutex_init(&server.mazeLock, NULL);
+
+    // sets up every worker with working space that lasts
+    server.workers = calloc(threads, sizeof(struct worker_s));
+    if(server.workers == NULL)
+    {
+        fprintf(stderr, "Unable to allocate %u workers.\n", threads);
+        exit(EXIT_FAILURE);
+    }
+    for(unsigned t = 0; t < threads; ++t)
+    {
+        struct worker_s *worker = &server.workers[t];
+        worker->server = &server;
+        worker->replyCapacity = 4096;
+        worker->reply = malloc(worker->replyCapacity);
+        worker->batcher = batch_createBatcher();
+        if(worker->reply == NULL || worker->batcher == NULL)
+        {
+            fprintf(stderr, "Unable to allocate worker %u.\n", t);
+            exit(EXIT_FAILURE);
+        }
+
+        int failed = pthread_create(&worker->thread, NULL, work, worker);
+        if(failed != 0)
+        {
+            fprintf(stderr, "Unable to start worker thread: %s\n",
+                    strerror(failed));
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // the connections waiting for their next request (only this thread
+    // touches them), and what poll watches: the listener, the wake up pipe,
+    // then each of them
+    int idle[MAX_CONNECTIONS];
+    size_t idleCount = 0;
+    struct pollfd watched[MAX_CONNECTIONS + 2];
+
+    // hands every request to the workers until we're told to stop
+    for(;;)
+    {
+        // takes back the connections the workers are done with
+        pthread_mutex_lock(&server.lock);
+        for(size_t i = 0; i < server.returnedCount; ++i)
+            idle[idleCount++] = server.returned[i];
+        server.returnedCount = 0;
+        bool stopping = server.stopping;
+        pthread_mutex_unlock(&server.lock);
+        if(stopping)
+            break;
+
+        watched[0].fd = server.listener;
+        watched[1].fd = server.wake[0];
+        for(size_t i = 0; i < idleCount; ++i)
+            watched[i + 2].fd = idle[i];
+        for(size_t i = 0; i < idleCount + 2; ++i)
+            watched[i].events = POLLIN;
+
+        if(poll(watched, idleCount + 2, -1) < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            perror("Error waiting for requests");
+            break;
+        }
+
+        // empties the wake up pipe (what it woke us for is seen to above)
+        if(watched[1].revents != 0)
+        {
+            char drain[64];
+            while(read(server.wake[0], drain, sizeof(drain)) > 0)
+                ;
+        }
+
+        // queues every connection with something to read: a request, or the
+        // end of the connection (which the worker finds and closes it on)
+        size_t still = 0;
+        pthread_mutex_lock(&server.lock);
+        for(size_t i = 0; i < idleCount; ++i)
+            if(watched[i + 2].revents != 0)
+            {
+                server.pending[(server.head + server.count) %
+                               MAX_CONNECTIONS] = idle[i];
+                ++server.count;
+                pthread_cond_signal(&server.ready);
+            }
+            else
+                idle[still++] = idle[i];
+        pthread_mutex_unlock(&server.lock);
+        idleCount = still;
+
+        // takes in a new connection
+        if(watched[0].revents != 0)
+        {
+            int fd = accept4(server.listener, NULL, NULL, SOCK_CLOEXEC);
+            if(fd < 0 && (errno == EINTR || errno == ECONNABORTED ||
+                          errno == EAGAIN || errno == EWOULDBLOCK))
+                continue;
+            if(fd < 0)
+            {
+                perror("Error accepting connection");
+                break;
+            }
+
+            // a connection we have no room for is turned away
+            pthread_mutex_lock(&server.lock);
+            bool room = server.connections < MAX_CONNECTIONS;
+            if(room)
+                ++server.connections;
+            pthread_mutex_unlock(&server.lock);
+
+            if(room)
+            {
+                setTimeouts(fd);
+                idle[idleCount++] = fd;
+            }
+            else
+                close(fd);
+        }
+    }
+
+    // stops the workers; each finishes the request it is answering first,
+    // which a client that stops sending can only drag out for
+    // REQUEST_TIMEOUT seconds
+    pthread_mutex_lock(&server.lock);
+    server.stopping = true;
+    pthread_cond_broadcast(&server.ready);
+    pthread_mutex_unlock(&server.lock);
+    for(unsigned t = 0; t < threads; ++t)
+        pthread_join(server.workers[t].thread, NULL);
+
+    // closes every connection still open
+    for(size_t i = 0; i < idleCount; ++i)
+        close(idle[i]);
+    for(size_t i = 0; i < server.count; ++i)
+        close(server.pending[(server.head + i) % MAX_CONNECTIONS]);
+    for(size_t i = 0; i < server.returnedCount; ++i)
+        close(server.returned[i]);
+    close(server.wake[0]);
+    close(server.wake[1]);
+
+    // tears everything down
+    close(server.listener);
+    unlink(path);
+    for(unsigned t = 0; t < threads; ++t)
+    {
+        ctx_destroy(server.workers[t].ctx);
+        free(server.workers[t].request);
+        free(server.workers[t].reply);
+        batch_destroyBatcher(server.workers[t].batcher);
+    }
+    free(server.workers);
+    while(server.mazes != NULL)
+    {
+        struct entry_s *entry = server.mazes;
+        server.mazes = entry->next;
+        freeEntry(entry);
+    }
+    pthread_mutex_destroy(&server.mazeLock);
+    pthread_cond_destroy(&server.ready);
+    pthread_mutex_destroy(&server.lock);
+
+    return true;
+}
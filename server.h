@@ -0,0 +1,49 @@
+///
+/// File: server.h
+///
+/// Description: Interface to the server mode, which keeps named mazes loaded
+///              and answers requests for them over a local Unix socket.
+///
+///              Every message, each way, is a frame: a 4 byte length (network
+///              byte order) followed by that many bytes of text. A request's
+///              first line is a command:
+///                  "load NAME PATH"  loads the maze in PATH (text or binary)
+///                                    as NAME, replacing any maze of that name.
+///                  "unload NAME"     forgets the maze called NAME.
+///                  "solve NAME"      answers entrance to exit.
+///                  "solve NAME r1 c1 r2 c2"
+///                                    answers (r1, c1) to (r2, c2).
+///                  "batch NAME"      answers every "r1 c1 r2 c2" line after
+///                                    this one, one answer per line (the
+///                                    queries sharing a source are answered
+///                                    by one BFS, as -q answers them).
+///                  "shutdown"        stops the server.
+///              Answers are "Solution in N steps.", "No solution." or
+///              "Invalid query."; the other commands answer "OK." or a line
+///              starting with "Error:".
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#ifndef _SERVER_H_
+#define _SERVER_H_
+
+#include <stdbool.h>
+
+///
+/// Runs the server until it is sent "shutdown". One thread polls every open
+/// connection and hands each request, as it arrives, to a pool of worker
+/// threads that answer it with working space they keep from request to
+/// request; an idle connection holds no worker.
+///
+/// @param path  the path of the Unix socket to listen on (it is created, and
+///              removed again when the server stops).
+/// @param threads  the number of worker threads (at least 1).
+///
+/// @return true if the server ran and stopped cleanly; false if it could not
+///         start (a message saying why has already been printed).
+///
+bool server_run( const char *path, unsigned threads );
+
+#endif
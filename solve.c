@@ -0,0 +1,505 @@
+///
+/// File: solve.c
+///
+/// Description: The search engines used to find the shortest path through a
+///              maze.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#include <stdbool.h> // boolean items
+#include <stdio.h> // error reporting
+#include <stdlib.h> // allocation functions
+#include "solve.h" // the functions we need to write are in here
+#include "queue.h" // queue related items
+#include "context.h" // working space kept between searches
+#include "stats.h" // instrumentation counters
+
+
+// a level is expanded bottom-up once the frontier has at least BOTTOM_UP_RATIO
+// cells for every word a bottom-up step would have to look at (a word op is
+// about as costly as pushing that many cells through the queue)
+#define BOTTOM_UP_RATIO 2
+
+
+///
+/// Function: getNeighbors
+///
+/// Description: Gets the neighbors of a certain location in the maze.
+///
+/// @param maze  The maze being searched.
+/// @param ctx  The context searching it (walls are marked as visited).
+/// @param findFor  The packed index of the cell we are looking to find the
+///                 neighbors of.
+///
+static void getNeighbors(Maze maze,
+                         SolverContext ctx,
+                         uint32_t findFor)
+{
+    // the four neighbors of the location we are searching from
+    uint32_t neighbors[4] = {
+        maze_east(maze, findFor),
+        maze_south(maze, findFor),
+        maze_west(maze, findFor),
+        maze_north(maze, findFor)
+    };
+
+    // determines if each neighbor is valid and adds it to queue if it is;
+    // walls and the border are already marked visited, so one test decides
+    // NOTE: for memory's sake, we mark it as visited here SO THE SAME NODE IS
+    //       NOT ADDED MORE THAN ONCE
+    // the rows around the cell may not have been reached by this search yet
+    uint64_t *visited = ctx->visited;
+    ctx_touchAround(ctx, findFor);
+
+    for(int i = 0; i < 4; ++i)
+        if(!bit_test(visited, neighbors[i]))
+        {
+            que_insert(ctx->queue, neighbors[i]);
+            bit_set(visited, neighbors[i]);
+        }
+}
+
+
+///
+/// Function: queueToBits
+///
+/// Description: Moves the cells of the frontier out of the queue and into the
+///              (empty) bitset frontier.
+///
+/// @param maze  The maze being searched.
+/// @param queue  The frontier to empty.
+/// @param *frontier  The bitset frontier to fill.
+///
+static void queueToBits(Maze maze,
+                        Queue queue,
+                        struct bitFrontier_s *frontier)
+{
+    uint32_t *first = frontier->first[0], *last = frontier->last[0];
+
+    frontier->lo = SIZE_MAX;
+    frontier->hi = 0;
+
+    while(!que_empty(queue))
+    {
+        uint32_t cell = que_remove(queue);
+        size_t row = cell / maze->stride;
+        uint32_t word = (uint32_t) (cell / 64 - row * frontier->rowWords);
+
+        bit_set(frontier->cells, cell);
+
+        // widens the window of the row and the rows the frontier spans
+        if(word < first[row])
+            first[row] = word;
+        if(word > last[row])
+            last[row] = word;
+        if(row < frontier->lo)
+            frontier->lo = row;
+        if(row > frontier->hi)
+            frontier->hi = row;
+    }
+}
+
+
+///
+/// Function: clearWindows
+///
+/// Description: Clears every word of the frontier and empties its windows.
+///
+/// @param *frontier  The frontier to clear.
+/// @param queue  If not NULL, every cell is moved into this queue first.
+///
+static void clearWindows(struct bitFrontier_s *frontier, Queue queue)
+{
+    uint32_t *first = frontier->first[0], *last = frontier->last[0];
+
+    for(size_t r = frontier->lo; r <= frontier->hi; ++r)
+    {
+        uint64_t *row = frontier->cells + r * frontier->rowWords;
+
+        for(uint32_t w = first[r]; w <= last[r] && first[r] != UINT32_MAX;
+            ++w)
+        {
+            // peels the set bits off the word one at a time
+            if(queue != NULL)
+                for(uint64_t bits = row[w]; bits != 0; bits &= bits - 1)
+                    que_insert(queue, (uint32_t) ((r * frontier->rowWords + w)
+                                                  * 64 +
+                                                  __builtin_ctzll(bits)));
+            row[w] = 0;
+        }
+
+        first[r] = UINT32_MAX;
+        last[r] = 0;
+    }
+}
+
+
+///
+/// Function: stepBottomUp
+///
+/// Description: Expands one level of the search bottom-up: instead of pushing
+///              each frontier cell out to its neighbors, every unvisited cell
+///              near the frontier checks whether one of its neighbors is in the
+///              frontier, 64 cells at a time with shifts on the bitsets. Only
+///              the words next to the window of frontier words in each row are
+///              looked at.
+///
+/// @param maze  The maze being searched.
+/// @param ctx  The context searching it (walls are marked as visited).
+/// @param *frontier  The bitset frontier; replaced with the next one.
+///
+/// @return the number of cells in the next frontier.
+///
+static size_t stepBottomUp(Maze maze,
+                           SolverContext ctx,
+                           struct bitFrontier_s *frontier)
+{
+    size_t rowWords = frontier->rowWords, count = 0, scanned = 0;
+    const uint64_t *cells = frontier->cells;
+    const uint32_t *first = frontier->first[0], *last = frontier->last[0];
+    uint32_t *nextFirst = frontier->first[1], *nextLast = frontier->last[1];
+    // the next frontier can only be in the rows around this one; the padded
+    // rows at the top and bottom are all walls so they are skipped
+    size_t top = (frontier->lo > 1) ? frontier->lo - 1 : 1;
+    size_t bottom = (frontier->hi < maze->rows) ? frontier->hi + 1
+                                                : maze->rows;
+    size_t newLo = SIZE_MAX, newHi = 0;
+
+    for(size_t r = top; r <= bottom; ++r)
+    {
+        // the words next to a frontier word in this row or the ones beside it
+        uint32_t from = first[r], to = last[r];
+        if(first[r - 1] < from)
+            from = first[r - 1];
+        if(first[r + 1] < from)
+            from = first[r + 1];
+        if(last[r - 1] > to)
+            to = last[r - 1];
+        if(last[r + 1] > to)
+            to = last[r + 1];
+
+        // nothing near this row
+        if(from == UINT32_MAX)
+            continue;
+
+        const uint64_t *row = cells + r * rowWords;
+
+        // a cell at the edge of the window may spill into the word beside it
+        if(from > 0 && ((row[from - rowWords] | row[from] |
+                         row[from + rowWords]) & 1))
+            --from;
+        if(to + 1 < rowWords && ((row[to - rowWords] | row[to] |
+                                  row[to + rowWords]) >> 63))
+            ++to;
+        scanned += to - from + 1;
+
+        uint64_t *seen = ctx->visited + r * rowWords;
+        uint64_t *out = frontier->next + r * rowWords;
+        ctx_touchRow(ctx, r);
+
+        for(uint32_t w = from; w <= to; ++w)
+        {
+            // the frontier cells to the WEST and EAST of each cell in the word
+            uint64_t west = (row[w] << 1) | ((w > 0) ? row[w - 1] >> 63 : 0);
+            uint64_t east = (row[w] >> 1) |
+                            ((w + 1 < rowWords) ? row[w + 1] << 63 : 0);
+
+            // any cell next to the frontier that hasn't been visited is next
+            uint64_t found = (west | east | row[w - rowWords] |
+                              row[w + rowWords]) & ~seen[w];
+
+            if(found)
+            {
+                seen[w] |= found;
+                out[w] = found;
+                count += (size_t) __builtin_popcountll(found);
+
+                // widens the window of the row in the next frontier
+                if(w < nextFirst[r])
+                    nextFirst[r] = w;
+                nextLast[r] = w;
+                if(r < newLo)
+                    newLo = r;
+                newHi = r;
+            }
+        }
+    }
+
+    // clears out the old frontier so it can be reused for the one after next
+    clearWindows(frontier, NULL);
+
+    // the next frontier becomes the one we expand next
+    uint64_t *swap = frontier->cells;
+    frontier->cells = frontier->next;
+    frontier->next = swap;
+    uint32_t *swapFirst = frontier->first[0], *swapLast = frontier->last[0];
+    frontier->first[0] = frontier->first[1];
+    frontier->last[0] = frontier->last[1];
+    frontier->first[1] = swapFirst;
+    frontier->last[1] = swapLast;
+
+    frontier->lo = newLo;
+    frontier->hi = newHi;
+    frontier->scanned = scanned;
+    return count;
+}
+
+
+/// finds the shortest path with a direction-optimizing BFS; the frontier is
+/// processed one level at a time so the step count does not need to be stored
+/// with each cell, and each level is either expanded top-down from a queue or
+/// bottom-up over bitsets, whichever looks at less
+size_t solve_bfsWith( SolverContext ctx, Maze maze, uint32_t start,
+                      uint32_t goal )
+{
+    /* we first check that the last and first spaces are open
+       waste of time if we can't get in/out of the maze */
+    if(bit_test(maze->walls, goal) || bit_test(maze->walls, start))
+        return 0;
+
+    // already there, it's a single step
+    if(start == goal)
+        return 1;
+
+    // starts the context over (nothing is cleared, the stamps move on)
+    if(!ctx_begin(ctx, maze))
+    {
+        fprintf(stderr, "Unable to grow the search to %zu words.\n",
+                maze->words);
+        exit(EXIT_FAILURE);
+    }
+
+    // the number of steps and the size of the frontier
+    size_t steps = 0, levelSteps = 1, levelSize = 1;
+
+    // the cell being searched from
+    uint32_t searching;
+
+    // the words a bottom-up step is expected to look at
+    size_t scanWords = 3;
+
+    // the frontier as a bitset, only made if we ever go bottom-up
+    struct bitFrontier_s *bits = NULL;
+    bool bottomUp = false;
+
+    // the queue is sized for a typical frontier and only grows if the maze
+    // needs a wider one
+    Queue q = ctx->queue;
+
+    // inserts the start; that is 1 step (we must step into the maze)
+    // NOTE: the goal's row is brought up to date now so it can be tested
+    //       after every level without a second thought
+    ctx_touchRow(ctx, goal / maze->stride);
+    ctx_touchRow(ctx, start / maze->stride);
+    que_insert(q, start);
+    bit_set(ctx->visited, start);
+
+    stat_search();
+
+    // keeps going while we still have cells in the frontier
+    while(levelSize > 0)
+    {
+        stat_level(levelSize);
+
+        // goes bottom-up once the frontier is dense in the words around it,
+        // and back top-down once it thins out again
+        if(!bottomUp && levelSize > scanWords * BOTTOM_UP_RATIO)
+        {
+            if(bits == NULL)
+                bits = ctx_frontier(ctx);
+
+            // if we can't have the bitsets we can keep going top-down
+            if(bits != NULL)
+            {
+                queueToBits(maze, q, bits);
+                bottomUp = true;
+            }
+        }
+        else if(bottomUp && levelSize * 2 < scanWords * BOTTOM_UP_RATIO)
+        {
+            clearWindows(bits, q);
+            bottomUp = false;
+        }
+
+        if(bottomUp)
+        {
+            levelSize = stepBottomUp(maze, ctx, bits);
+            scanWords = bits->scanned;
+        }
+        else
+        {
+            // the first and last cells of the level; the queue holds the
+            // frontier in the order it was found, which runs from one end of
+            // the wavefront to the other, so these give the rows it spans
+            size_t first = que_peek(q, 0) / maze->stride;
+            size_t last = que_peek(q, levelSize - 1) / maze->stride;
+
+            // every cell currently in the queue is levelSteps steps away
+            for(; levelSize > 0; --levelSize)
+            {
+                // removes the next cell
+                searching = que_remove(q);
+
+                // gets our valid neighbors and adds them to the queue
+                getNeighbors(maze, ctx, searching);
+            }
+
+            // at best a bottom-up step looks at about one word in each row of
+            // the new frontier, which is at most a row beyond the old one
+            levelSize = que_size(q);
+            scanWords = ((first < last) ? last - first : first - last) + 3;
+        }
+
+        // the cells we just found are one step further away
+        ++levelSteps;
+
+        // if we reached the solution we can stop searching
+        if(bit_test(ctx->visited, goal))
+        {
+            steps = levelSteps;
+            break;
+        }
+    }
+
+    // leaves the bitsets empty for the next search (the queue is emptied when
+    // the next one begins)
+    if(bottomUp)
+        clearWindows(bits, NULL);
+
+    /* if steps is STILL 0 here we have run out of spaces to inspect and there
+       is no solution */
+    return steps;
+}
+
+
+/// a one-off search with a context of its own
+size_t solve_bfs( Maze maze, uint32_t start, uint32_t goal )
+{
+    SolverContext ctx = ctx_create(maze);
+    if(ctx == NULL)
+    {
+        fprintf(stderr, "Unable to allocate a search of %zu words.\n",
+                maze->words);
+        exit(EXIT_FAILURE);
+    }
+
+    size_t steps = solve_bfsWith(ctx, maze, start, goal);
+    ctx_destroy(ctx);
+
+    return steps;
+}
+
+
+///
+/// Function: expandLevel
+///
+/// Description: Expands one whole level of one side of a bidirectional search,
+///              watching for a neighbor the other side has already reached.
+///
+/// @param maze  The maze being searched.
+/// @param queue  The frontier of this side.
+/// @param visited  The visitation map of this side.
+/// @param other  The visitation map of the other side.
+///
+/// @return true if the two sides met; false otherwise.
+///
+static bool expandLevel(Maze maze,
+                        Queue queue,
+                        uint64_t *visited,
+                        const uint64_t *other)
+{
+    stat_level(que_size(queue));
+    for(size_t levelSize = que_size(queue); levelSize > 0; --levelSize)
+    {
+        uint32_t searching = que_remove(queue);
+
+        // the four neighbors of the location we are searching from
+        uint32_t neighbors[4] = {
+            maze_east(maze, searching),
+            maze_south(maze, searching),
+            maze_west(maze, searching),
+            maze_north(maze, searching)
+        };
+
+        for(int i = 0; i < 4; ++i)
+            if(!bit_test(visited, neighbors[i]))
+            {
+                // the other side got here first, so the paths join up here
+                if(bit_test(other, neighbors[i]))
+                    return true;
+
+                que_insert(queue, neighbors[i]);
+                bit_set(visited, neighbors[i]);
+            }
+    }
+
+    return false;
+}
+
+
+/// finds the shortest path with a BFS from both ends
+/// NOTE: the first time the sides meet, the cell reached must be on the other
+///       side's frontier (had it been expanded, the meeting would have been
+///       seen earlier), so the path length is simply the sum of both depths
+size_t solve_bidirectional( Maze maze, uint32_t start, uint32_t goal )
+{
+    // waste of time if we can't get in/out of the maze
+    if(bit_test(maze->walls, goal) || bit_test(maze->walls, start))
+        return 0;
+
+    // already there, it's a single step
+    if(start == goal)
+        return 1;
+
+    // the frontier, visitation map and depth (levels finished) of each side
+    Queue q[2] = {
+        que_create(2 * (maze->rows + maze->cols)),
+        que_create(2 * (maze->rows + maze->cols))
+    };
+    uint64_t *visited[2] = {
+        maze_createVisitedMap(maze),
+        maze_createVisitedMap(maze)
+    };
+    size_t depth[2] = { 0, 0 }, steps = 0;
+    if(q[0] == NULL || q[1] == NULL || visited[0] == NULL ||
+       visited[1] == NULL)
+    {
+        fprintf(stderr, "Unable to allocate a search of %zu words.\n",
+                maze->words);
+        exit(EXIT_FAILURE);
+    }
+
+    // one side starts at the start, the other at the goal
+    que_insert(q[0], start);
+    bit_set(visited[0], start);
+    que_insert(q[1], goal);
+    bit_set(visited[1], goal);
+
+    // if either side runs out of cells there is no path
+    stat_search();
+    while(!que_empty(q[0]) && !que_empty(q[1]))
+    {
+        // always grows the smaller frontier
+        int side = (que_size(q[0]) <= que_size(q[1])) ? 0 : 1;
+
+        if(expandLevel(maze, q[side], visited[side], visited[!side]))
+        {
+            // both paths, the step that joins them and the start cell
+            steps = depth[0] + depth[1] + 2;
+            break;
+        }
+
+        ++depth[side];
+    }
+
+    // tears down both sides
+    for(int side = 0; side < 2; ++side)
+    {
+        que_destroy(q[side]);
+        maze_clearVisitedMap(visited[side]);
+    }
+
+    return steps;
+}
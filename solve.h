@@ -0,0 +1,181 @@
+///
+/// File: solve.h
+///
+/// Description: Interface to the search engines used to solve a Maze.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#ifndef _SOLVE_H_
+#define _SOLVE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "maze.h"
+#include "context.h"
+
+// the search engines a maze can be solved with
+typedef enum algorithm_e{
+    // plain (direction-optimizing) breadth first search
+    ALGO_BFS,
+    // breadth first search from both ends at once
+    ALGO_BIDIR,
+    // A* with a Manhattan distance heuristic
+    ALGO_ASTAR,
+    // Jump Point Search
+    ALGO_JPS
+} Algorithm;
+
+///
+/// Uses BFS to determine the shortest number of steps from one cell to another.
+///
+/// @param maze  the maze to search.
+/// @param start  the packed index of the cell to start from.
+/// @param goal  the packed index of the cell to get to.
+///
+/// @return 0 if there is no path, otherwise the number of cells on the
+///         shortest path (the start and goal included).
+///
+size_t solve_bfs( Maze maze, uint32_t start, uint32_t goal );
+
+///
+/// The same search as solve_bfs, but in working space kept by the caller, so a
+/// run of searches allocates nothing after the first (and never clears the
+/// whole visitation map).
+///
+/// @param ctx  the context to search with.
+/// @param maze  the maze to search.
+/// @param start  the packed index of the cell to start from.
+/// @param goal  the packed index of the cell to get to.
+///
+/// @return 0 if there is no path, otherwise the number of cells on the
+///         shortest path (the start and goal included).
+/// @exception If the context cannot grow to fit the maze, the program
+///     terminates with an error message printed to the standard error output
+///     and an exit status of EXIT_FAILURE.
+///
+size_t solve_bfsWith( SolverContext ctx, Maze maze, uint32_t start,
+                      uint32_t goal );
+
+///
+/// Uses a bidirectional BFS to determine the shortest number of steps from one
+/// cell to another. Frontiers are grown from both ends, always expanding the
+/// smaller one by a whole level, until they meet.
+///
+/// @param maze  the maze to search.
+/// @param start  the packed index of the cell to start from.
+/// @param goal  the packed index of the cell to get to.
+///
+/// @return 0 if there is no path, otherwise the number of cells on the
+///         shortest path (the same count solve_bfs gives).
+///
+size_t solve_bidirectional( Maze maze, uint32_t start, uint32_t goal );
+
+///
+/// Uses a multithreaded, level-synchronous BFS to determine the shortest number
+/// of steps from one cell to another (found in parallel.c).
+///
+/// @param maze  the maze to search.
+/// @param start  the packed index of the cell to start from.
+/// @param goal  the packed index of the cell to get to.
+/// @param threads  the number of threads to search with (at least 1).
+///
+/// @return 0 if there is no path, otherwise the number of cells on the
+///         shortest path (the same count solve_bfs gives).
+///
+size_t solve_parallel( Maze maze, uint32_t start, uint32_t goal,
+                       unsigned threads );
+
+///
+/// Uses A* with a Manhattan distance heuristic to determine the shortest number
+/// of steps from one cell to another (found in astar.c).
+///
+/// @param maze  the maze to search.
+/// @param start  the packed index of the cell to start from.
+/// @param goal  the packed index of the cell to get to.
+///
+/// @return 0 if there is no path, otherwise the number of cells on the
+///         shortest path (the same count solve_bfs gives).
+///
+size_t solve_astar( Maze maze, uint32_t start, uint32_t goal );
+
+///
+/// Uses Jump Point Search to determine the shortest number of steps from one
+/// cell to another (found in astar.c). Straight runs of cells with nothing
+/// new beside them are jumped over, so only their ends go in the heap.
+///
+/// @param maze  the maze to search.
+/// @param start  the packed index of the cell to start from.
+/// @param goal  the packed index of the cell to get to.
+///
+/// @return 0 if there is no path, otherwise the number of cells on the
+///         shortest path (the same count solve_bfs gives).
+///
+size_t solve_jps( Maze maze, uint32_t start, uint32_t goal );
+
+///
+/// Uses an external memory BFS to determine the shortest number of steps from
+/// one cell to another (found in external.c). The visitation map and the
+/// frontiers are kept in scratch files, which are read and written in order
+/// of cell, so a maze mapped from a binary maze file (not run-length encoded)
+/// can be solved with far less memory than it takes up.
+///
+/// @param maze  the maze to search.
+/// @param start  the packed index of the cell to start from.
+/// @param goal  the packed index of the cell to get to.
+/// @param dir  the directory to keep the scratch files in (they are unlinked
+///             as soon as they are made).
+///
+/// @return 0 if there is no path, otherwise the number of cells on the
+///         shortest path (the same count solve_bfs gives).
+/// @exception If a scratch file cannot be made, read or written, the program
+///     terminates with an error message printed to the standard error output
+///     and an exit status of EXIT_FAILURE.
+///
+size_t solve_external( Maze maze, uint32_t start, uint32_t goal,
+                       const char *dir );
+
+///
+/// Uses a BFS over bands of rows to determine the shortest number of steps
+/// from one cell to another (found in sweep.c). Only the band being searched
+/// and the first and last rows of every band are held, and bands are searched
+/// again until none of those rows change, so smaller bands hold less at the
+/// cost of more searches.
+///
+/// @param maze  the maze to search.
+/// @param start  the packed index of the cell to start from.
+/// @param goal  the packed index of the cell to get to.
+/// @param bandRows  the number of rows in a band, or 0 for the size that holds
+///                  the least (about 8 times the square root of the rows).
+///
+/// @return 0 if there is no path, otherwise the number of cells on the
+///         shortest path (the same count solve_bfs gives).
+/// @exception If the memory for the band cannot be had, the program
+///     terminates with an error message printed to the standard error output
+///     and an exit status of EXIT_FAILURE.
+///
+size_t solve_sweep( Maze maze, uint32_t start, uint32_t goal,
+                    size_t bandRows );
+
+///
+/// Uses BFS to find the shortest path from one cell to another (found in
+/// path.c). Predecessors are kept as 2-bit directions, so the search needs a
+/// quarter of a byte per cell on top of its visitation map.
+///
+/// @param maze  the maze to search.
+/// @param start  the packed index of the cell to start from.
+/// @param goal  the packed index of the cell to get to.
+/// @param path  set to a malloc'd array of the packed indices of the cells on
+///              the path, start first and goal last (NULL if there is no
+///              path); the caller frees it.
+///
+/// @return 0 if there is no path, otherwise the number of cells on the
+///         shortest path (the length of *path).
+/// @exception If the memory for the search or the path cannot be had, the
+///     program terminates with an error message printed to the standard
+///     error output and an exit status of EXIT_FAILURE.
+///
+size_t solve_path( Maze maze, uint32_t start, uint32_t goal, uint32_t **path );
+
+#endif
@@ -0,0 +1,379 @@
+///
+/// File: stats.c
+///
+/// Description: The counters and timers behind --stats.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#define _GNU_SOURCE
+#include <errno.h> // why the hardware counters couldn't be opened
+#include <stdio.h> // writing the report
+#include <string.h> // memset, strerror
+#include <time.h> // clock_gettime
+#include <sys/resource.h> // getrusage
+#ifdef __GLIBC__
+#if __GLIBC_PREREQ(2, 33)
+#define HAVE_MALLINFO2
+#include <malloc.h> // mallinfo2
+#endif
+#endif
+#ifdef __linux__
+#include <unistd.h> // read, syscall
+#include <sys/syscall.h> // SYS_perf_event_open
+#include <linux/perf_event.h> // hardware counter events
+#endif
+#include "stats.h" // stats functions and structures
+
+// the names of the phases, in the same order as the StatPhase enum
+static const char *phaseNames[STAT_PHASES] = {
+    "read", "prepare", "solve", "query", "print"
+};
+
+__thread StatCounters stat_local;
+
+// the counters every thread has flushed
+static StatCounters totals;
+
+// the time spent in each phase, and when each one was last started (only the
+// main thread times phases)
+static double phaseSeconds[STAT_PHASES], phaseStarted[STAT_PHASES];
+
+// the hardware counters read around each phase
+enum { PERF_CYCLES, PERF_INSTRUCTIONS, PERF_LLC_MISSES, PERF_BRANCH_MISSES,
+       PERF_COUNTERS };
+
+// their names in the JSON
+static const char *perfNames[PERF_COUNTERS] = {
+    "cycles", "instructions", "llcMisses", "branchMisses"
+};
+
+// the counters' file descriptors (-1 for one that couldn't be opened), and
+// whether any could
+static int perfFds[PERF_COUNTERS] = { -1, -1, -1, -1 };
+static bool perfOn = false;
+
+// the counts in each phase and where they stood when it was last started,
+// and the same for the work done in it (bytes read in the read phase, cells
+// expanded in the others), which the misses are given per unit of
+static double perfCounts[STAT_PHASES][PERF_COUNTERS],
+              perfStarted[STAT_PHASES][PERF_COUNTERS];
+static uint64_t phaseUnits[STAT_PHASES], unitsStarted[STAT_PHASES];
+
+
+///
+/// Function: now
+///
+/// Description: Gets the time on a clock that only moves forward.
+///
+/// @return the time, in seconds.
+///
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+
+///
+/// Function: readCounter
+///
+/// Description: Reads a hardware counter, scaled up for any time it spent
+///              off the PMU while the kernel shared it with other counters.
+///
+/// @param fd  The counter's file descriptor.
+///
+/// @return the count so far.
+///
+static double readCounter(int fd)
+{
+#ifdef __linux__
+    // the count, the time it was enabled and the time it was counting
+    uint64_t values[3];
+    if(read(fd, values, sizeof(values)) != (ssize_t) sizeof(values) ||
+       values[2] == 0)
+        return 0;
+    return (double) values[0] * ((double) values[1] / (double) values[2]);
+#else
+    (void) fd;
+    return 0;
+#endif
+}
+
+
+///
+/// Function: phaseWork
+///
+/// Description: Gets the work done so far that a phase's misses are given
+///              per unit of: the bytes read for the read phase, the cells
+///              expanded for the others. The threads that have not flushed
+///              yet (other than this one) are not counted, so workers must
+///              finish inside the phase they work in.
+///
+/// @param phase  The phase.
+///
+/// @return the units of work done so far.
+///
+static uint64_t phaseWork(StatPhase phase)
+{
+    if(phase == STAT_READ)
+        return __atomic_load_n(&totals.bytesRead, __ATOMIC_RELAXED) +
+               stat_local.bytesRead;
+    return __atomic_load_n(&totals.expanded, __ATOMIC_RELAXED) +
+           stat_local.expanded;
+}
+
+
+/// adds to the totals atomically, since threads finish whenever they do
+void stat_flush( void )
+{
+    __atomic_fetch_add(&totals.searches, stat_local.searches,
+                       __ATOMIC_RELAXED);
+    __atomic_fetch_add(&totals.expanded, stat_local.expanded,
+                       __ATOMIC_RELAXED);
+    __atomic_fetch_add(&totals.levels, stat_local.levels, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&totals.bytesRead, stat_local.bytesRead,
+                       __ATOMIC_RELAXED);
+
+    // the peak is the largest any thread saw
+    uint64_t peak = __atomic_load_n(&totals.peakFrontier, __ATOMIC_RELAXED);
+    while(stat_local.peakFrontier > peak &&
+          !__atomic_compare_exchange_n(&totals.peakFrontier, &peak,
+                                       stat_local.peakFrontier, false,
+                                       __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+
+    memset(&stat_local, 0, sizeof(stat_local));
+}
+
+
+/// opens every counter on its own (a group can't be inherited by threads),
+/// keeping whichever the CPU and kernel allow
+bool stat_perfOpen( void )
+{
+#ifdef __linux__
+    const uint64_t events[PERF_COUNTERS] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+    };
+    int reason = 0;
+
+    for(int e = 0; e < PERF_COUNTERS; ++e)
+    {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = events[e];
+        // the threads started from here on are counted too, and only our own
+        // code (which is all an unprivileged user may count anyway)
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                           PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        perfFds[e] = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1,
+                                   PERF_FLAG_FD_CLOEXEC);
+        if(perfFds[e] >= 0)
+            perfOn = true;
+        else if(reason == 0)
+            reason = errno;
+    }
+
+    if(!perfOn)
+        fprintf(stderr, "Hardware counters unavailable: %s\n",
+                strerror(reason));
+    else if(reason != 0)
+        fprintf(stderr, "Some hardware counters unavailable: %s\n",
+                strerror(reason));
+    return perfOn;
+#else
+    fprintf(stderr, "Hardware counters are only available on Linux.\n");
+    return false;
+#endif
+}
+
+
+/// remembers when the phase started (the counters last, so as little of
+/// this as can be is counted)
+void stat_start( StatPhase phase )
+{
+    phaseStarted[phase] = now();
+    if(perfOn)
+    {
+        unitsStarted[phase] = phaseWork(phase);
+        for(int e = 0; e < PERF_COUNTERS; ++e)
+            if(perfFds[e] >= 0)
+                perfStarted[phase][e] = readCounter(perfFds[e]);
+    }
+}
+
+
+/// adds what has happened since the phase started (the counters first)
+void stat_stop( StatPhase phase )
+{
+    if(perfOn)
+    {
+        for(int e = 0; e < PERF_COUNTERS; ++e)
+            if(perfFds[e] >= 0)
+                perfCounts[phase][e] += readCounter(perfFds[e]) -
+                                        perfStarted[phase][e];
+        phaseUnits[phase] += phaseWork(phase) - unitsStarted[phase];
+    }
+    phaseSeconds[phase] += now() - phaseStarted[phase];
+}
+
+
+///
+/// Function: printColumn
+///
+/// Description: Prints a column of the counter report, or a dash if it
+///              can't be had.
+///
+/// @param text  The stream the report is written to.
+/// @param width  The width of the column.
+/// @param precision  The digits after the point.
+/// @param have  Whether the value can be had.
+/// @param value  The value.
+///
+static void printColumn(FILE *text, int width, int precision, bool have,
+                        double value)
+{
+    if(have)
+        fprintf(text, " %*.*f", width, precision, value);
+    else
+        fprintf(text, " %*s", width, "-");
+}
+
+
+///
+/// Function: reportPerf
+///
+/// Description: Writes the hardware counters of each phase: the cycles, the
+///              instructions per cycle, and the last level cache and branch
+///              misses, in all and per unit of work.
+///
+/// @param text  The stream the report is written to for people, or NULL.
+/// @param json  The stream the report is written to as JSON, or NULL (the
+///              counters are written as the "perf" member of the object).
+///
+static void reportPerf(FILE *text, FILE *json)
+{
+    if(text != NULL)
+    {
+        fprintf(text, "Phase    %12s %6s %12s %12s %11s %11s\n", "Cycles",
+                "IPC", "LLC misses", "Br misses", "LLC/unit", "Br/unit");
+        for(int p = 0; p < STAT_PHASES; ++p)
+        {
+            const double *counts = perfCounts[p];
+            double units = (double) phaseUnits[p];
+            bool have[PERF_COUNTERS];
+            for(int e = 0; e < PERF_COUNTERS; ++e)
+                have[e] = perfFds[e] >= 0;
+
+            fprintf(text, "%-8s", phaseNames[p]);
+            printColumn(text, 12, 0, have[PERF_CYCLES], counts[PERF_CYCLES]);
+            printColumn(text, 6, 2, have[PERF_INSTRUCTIONS] &&
+                        have[PERF_CYCLES] && counts[PERF_CYCLES] > 0,
+                        counts[PERF_INSTRUCTIONS] / counts[PERF_CYCLES]);
+            for(int e = PERF_LLC_MISSES; e <= PERF_BRANCH_MISSES; ++e)
+                printColumn(text, 12, 0, have[e], counts[e]);
+            for(int e = PERF_LLC_MISSES; e <= PERF_BRANCH_MISSES; ++e)
+                printColumn(text, 11, 3, have[e] && units > 0,
+                            counts[e] / units);
+            fprintf(text, "\n");
+        }
+        fprintf(text, "(a unit is a byte read for read, a cell expanded "
+                      "otherwise)\n");
+    }
+
+    if(json != NULL)
+    {
+        fprintf(json, ", \"perf\": {");
+        for(int p = 0; p < STAT_PHASES; ++p)
+        {
+            fprintf(json, "%s\"%s\": {", (p > 0) ? ", " : "", phaseNames[p]);
+            for(int e = 0; e < PERF_COUNTERS; ++e)
+                if(perfFds[e] >= 0)
+                    fprintf(json, "\"%s\": %.0f, ", perfNames[e],
+                            perfCounts[p][e]);
+                else
+                    fprintf(json, "\"%s\": null, ", perfNames[e]);
+            fprintf(json, "\"units\": %llu}",
+                    (unsigned long long) phaseUnits[p]);
+        }
+        fprintf(json, "}");
+    }
+}
+
+
+/// asks the allocator, where it can tell us
+size_t stat_heapBytes( void )
+{
+#ifdef HAVE_MALLINFO2
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+
+/// flushes this thread, then writes the totals out both ways
+void stat_report( FILE *text, FILE *json )
+{
+    stat_flush();
+
+    double total = 0;
+    for(int p = 0; p < STAT_PHASES; ++p)
+        total += phaseSeconds[p];
+
+    // the heap still in use, and the most memory ever resident
+    size_t heapBytes = stat_heapBytes();
+    struct rusage usage;
+    long peakKb = (getrusage(RUSAGE_SELF, &usage) == 0) ? usage.ru_maxrss : 0;
+
+    if(text != NULL)
+    {
+        fprintf(text, "Phase    Seconds\n");
+        for(int p = 0; p < STAT_PHASES; ++p)
+            fprintf(text, "%-8s %.6f\n", phaseNames[p], phaseSeconds[p]);
+        fprintf(text, "%-8s %.6f\n", "total", total);
+        fprintf(text, "Searches:       %llu\n"
+                      "Cells expanded: %llu\n"
+                      "Levels:         %llu\n"
+                      "Peak frontier:  %llu\n"
+                      "Bytes read:     %llu\n"
+                      "Heap in use:    %zu bytes\n"
+                      "Peak resident:  %ld KB\n",
+                (unsigned long long) totals.searches,
+                (unsigned long long) totals.expanded,
+                (unsigned long long) totals.levels,
+                (unsigned long long) totals.peakFrontier,
+                (unsigned long long) totals.bytesRead, heapBytes, peakKb);
+        if(perfOn)
+            reportPerf(text, NULL);
+    }
+
+    if(json != NULL)
+    {
+        fprintf(json, "{\"phases\": {");
+        for(int p = 0; p < STAT_PHASES; ++p)
+            fprintf(json, "\"%s\": %.6f, ", phaseNames[p], phaseSeconds[p]);
+        fprintf(json, "\"total\": %.6f}, \"searches\": %llu, "
+                "\"cellsExpanded\": %llu, \"levels\": %llu, "
+                "\"peakFrontier\": %llu, \"bytesRead\": %llu, "
+                "\"heapBytes\": %zu, \"peakResidentKb\": %ld", total,
+                (unsigned long long) totals.searches,
+                (unsigned long long) totals.expanded,
+                (unsigned long long) totals.levels,
+                (unsigned long long) totals.peakFrontier,
+                (unsigned long long) totals.bytesRead, heapBytes, peakKb);
+        if(perfOn)
+            reportPerf(NULL, json);
+        fprintf(json, "}\n");
+    }
+}
@@ -0,0 +1,152 @@
+///
+/// File: stats.h
+///
+/// Description: Interface to the Stats module, the counters and timers behind
+///              --stats.
+///
+///              The counters are always on. Every thread counts into its own
+///              thread-local copy, a handful of adds a search level (or a heap
+///              pop), so nothing is shared while searching; a thread hands its
+///              counts over to the totals with stat_flush when it is done, and
+///              the report flushes the thread that makes it.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#ifndef _STATS_H_
+#define _STATS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// the phases of a run that are timed
+typedef enum statPhase_e{
+    // reading and parsing the maze
+    STAT_READ,
+    // building what the searches use (distances, graphs, labels)
+    STAT_PREPARE,
+    // solving the maze for -s and -p
+    STAT_SOLVE,
+    // answering queries and commands
+    STAT_QUERY,
+    // printing the maze
+    STAT_PRINT,
+    // the number of phases
+    STAT_PHASES
+} StatPhase;
+
+// the counters every thread keeps
+typedef struct statCounters_s{
+    // the searches run
+    uint64_t searches;
+    // the cells taken off a frontier (or out of a heap) and expanded
+    uint64_t expanded;
+    // the levels searched, by the searches that go a level at a time
+    uint64_t levels;
+    // the most cells in a frontier (or a heap) at once
+    uint64_t peakFrontier;
+    // the bytes of maze read in
+    uint64_t bytesRead;
+} StatCounters;
+
+// this thread's counters
+extern __thread StatCounters stat_local;
+
+///
+/// Counts a search being started.
+///
+static inline void stat_search( void )
+{
+    ++stat_local.searches;
+}
+
+///
+/// Counts a level of a search, about to be expanded.
+///
+/// @param cells  the cells in the level.
+///
+static inline void stat_level( size_t cells )
+{
+    ++stat_local.levels;
+    stat_local.expanded += cells;
+    if(cells > stat_local.peakFrontier)
+        stat_local.peakFrontier = cells;
+}
+
+///
+/// Counts cells expanded by a search that does not go a level at a time.
+///
+/// @param cells  the cells expanded.
+/// @param frontier  the cells waiting to be expanded.
+///
+static inline void stat_expand( size_t cells, size_t frontier )
+{
+    stat_local.expanded += cells;
+    if(frontier > stat_local.peakFrontier)
+        stat_local.peakFrontier = frontier;
+}
+
+///
+/// Counts bytes of maze read in.
+///
+/// @param bytes  the bytes read.
+///
+static inline void stat_read( size_t bytes )
+{
+    stat_local.bytesRead += bytes;
+}
+
+///
+/// Adds this thread's counters to the totals and starts them over. A thread
+/// that counts anything must call this before it exits.
+///
+void stat_flush( void );
+
+///
+/// Opens the hardware counters (cycles, instructions, last level cache misses
+/// and branch misses) of this thread and every thread started after it, so
+/// each phase reports them too. Whichever can't be opened (the kernel may not
+/// allow it, or a virtual machine may not have them) are left out.
+///
+/// @return true if any could be opened; false if none could (the reason is
+///         printed).
+///
+bool stat_perfOpen( void );
+
+///
+/// Starts timing a phase.
+///
+/// @param phase  the phase.
+///
+void stat_start( StatPhase phase );
+
+///
+/// Stops timing a phase, adding the time since it was started to it.
+///
+/// @param phase  the phase.
+///
+void stat_stop( StatPhase phase );
+
+///
+/// Gets the memory allocated from the heap and not yet freed (mallinfo2,
+/// which glibc has had since 2.33).
+///
+/// @return the memory, in bytes (0 where it cannot be had).
+///
+size_t stat_heapBytes( void );
+
+///
+/// Writes the report: the time spent in each phase, the totals of the
+/// counters, the heap in use and, if they were opened, the hardware counters
+/// of each phase.
+///
+/// @param text  the stream the report is written to for people, or NULL.
+/// @param json  the stream the report is written to as a JSON object, or
+///              NULL.
+///
+void stat_report( FILE *text, FILE *json );
+
+#endif
@@ -0,0 +1,332 @@
+///
+/// File: sweep.c
+///
+/// Description: A BFS that keeps only one band of rows' distances in memory at
+///              a time, for step counts on mazes whose visitation map (and
+///              queue) would be too much to hold.
+///
+///              The rows are cut into bands. Only the first and last row of
+///              every band are kept between visits; a band is searched by
+///              seeding it with the start (if it holds it) and with one more
+///              than the distances in the rows just outside it (the last row
+///              of the band above, the first row of the band below), which is
+///              all a path into the band can have come through. If that
+///              changes the band's own first or last row, the band next to it
+///              on that side may have to be searched again. The distances only
+///              ever go down, so this settles, and when it has every kept row
+///              holds its true distance and the goal's band can be searched
+///              one last time for the answer.
+///
+///              A band of R rows needs R * stride / 8 bytes while it is
+///              searched and every band keeps 8 * cols, so the smaller the
+///              bands the less the search holds at once, until the kept rows
+///              outweigh it; in exchange a path that winds up and down across
+///              many bands makes them be searched many times.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#include <math.h> // sqrt
+#include <stdbool.h> // boolean items
+#include <stdio.h> // error reporting
+#include <stdlib.h> // allocation functions, qsort
+#include <string.h> // memcpy
+#include "solve.h" // the function we need to write is in here
+#include "queue.h" // queue related items
+#include "stats.h" // instrumentation counters
+
+// the distance of a cell that has not been reached
+#define UNREACHED UINT32_MAX
+
+// a cell a band's search starts from, and its distance
+struct seed_s{
+    uint32_t steps, cell;
+};
+
+// everything a sweep keeps between the searches of its bands
+struct sweep_s{
+    Maze maze;
+    size_t bandRows, bands;
+    uint32_t start, goal;
+    // the distances of the first and last row of every band (2 * cols to a
+    // band, first row first)
+    uint32_t *edges;
+    // whether each band has to be searched (again)
+    bool *dirty;
+    // the cells of the band being searched that have been reached (laid out
+    // like the band's rows of the wall plane, which it starts as a copy of)
+    uint64_t *seen;
+    // the distances of the first and last row of the band being searched,
+    // and of the goal
+    uint32_t *firstRow, *lastRow, goalSteps;
+    // the seeds of the band being searched (2 * cols + 1)
+    struct seed_s *seeds;
+    Queue queue;
+};
+
+
+///
+/// Function: compareSeeds
+///
+/// Description: Orders seeds by distance, for qsort.
+///
+static int compareSeeds(const void *a, const void *b)
+{
+    uint32_t x = ((const struct seed_s *) a)->steps,
+             y = ((const struct seed_s *) b)->steps;
+    return (x > y) - (x < y);
+}
+
+
+///
+/// Function: addRow
+///
+/// Description: Seeds the open cells of a row of a band with one more than the
+///              distances of the row beside it.
+///
+/// @param sweep  The sweep.
+/// @param row  The row of the band to seed.
+/// @param beside  The distances of the row beside it (cols of them).
+/// @param count  The number of seeds so far, which is added to.
+///
+static void addRow(struct sweep_s *sweep, size_t row, const uint32_t *beside,
+                   size_t *count)
+{
+    Maze maze = sweep->maze;
+    for(size_t c = 0; c < maze->cols; ++c)
+        if(beside[c] != UNREACHED && !maze_isWall(maze, row, c))
+        {
+            sweep->seeds[*count].steps = beside[c] + 1;
+            sweep->seeds[*count].cell = maze_cell(maze, row, c);
+            ++*count;
+        }
+}
+
+
+///
+/// Function: reachCell
+///
+/// Description: Marks a cell of the band being searched as reached, keeping its
+///              distance if it is in the band's first or last row or is the
+///              goal.
+///
+/// @param sweep  The sweep.
+/// @param cell  The packed index of the cell.
+/// @param steps  Its distance.
+/// @param first  The first packed index of the band.
+/// @param end  The packed index past the band.
+///
+static inline void reachCell(struct sweep_s *sweep, uint32_t cell,
+                             uint32_t steps, uint32_t first, uint32_t end)
+{
+    uint32_t stride = (uint32_t) sweep->maze->stride;
+
+    bit_set(sweep->seen, cell - first);
+    if(cell - first < stride)
+        sweep->firstRow[cell - first - 1] = steps;
+    if(end - cell <= stride)
+        sweep->lastRow[cell - (end - stride) - 1] = steps;
+    if(cell == sweep->goal)
+        sweep->goalSteps = steps;
+}
+
+
+///
+/// Function: searchBand
+///
+/// Description: Searches one band from its seeds, then keeps its first and
+///              last rows, marking the bands beside them that may have to be
+///              searched again.
+///
+/// @param sweep  The sweep.
+/// @param band  The band to search.
+///
+/// @return the distance the search gave the goal (UNREACHED if the goal is
+///         not in the band or was not reached).
+///
+static uint32_t searchBand(struct sweep_s *sweep, size_t band)
+{
+    Maze maze = sweep->maze;
+    size_t cols = maze->cols;
+    size_t top = band * sweep->bandRows;
+    size_t bottom = top + sweep->bandRows;
+    if(bottom > maze->rows)
+        bottom = maze->rows;
+
+    // the packed cells of the band run from first up to (not including) end,
+    // whole padded rows of them
+    uint32_t first = maze_cell(maze, top, 0) - 1;
+    uint32_t end = maze_cell(maze, bottom, 0) - 1;
+    memcpy(sweep->seen, maze->walls + first / 64, (end - first) / 8);
+    for(size_t c = 0; c < cols; ++c)
+        sweep->firstRow[c] = sweep->lastRow[c] = UNREACHED;
+    sweep->goalSteps = UNREACHED;
+
+    // the seeds, nearest first
+    size_t count = 0;
+    if(sweep->start >= first && sweep->start < end)
+    {
+        sweep->seeds[0].steps = 1;
+        sweep->seeds[0].cell = sweep->start;
+        count = 1;
+    }
+    if(band > 0)
+        addRow(sweep, top, sweep->edges + (band - 1) * 2 * cols + cols,
+               &count);
+    if(band + 1 < sweep->bands)
+        addRow(sweep, bottom - 1, sweep->edges + (band + 1) * 2 * cols,
+               &count);
+    qsort(sweep->seeds, count, sizeof(struct seed_s), compareSeeds);
+
+    // a BFS a level at a time, taking in each seed at its own level
+    Queue q = sweep->queue;
+    que_clear(q);
+    size_t next = 0;
+    for(uint32_t level = (count > 0) ? sweep->seeds[0].steps : 0;
+        next < count || !que_empty(q); ++level)
+    {
+        // nothing left at this level, so skips to the next seed
+        if(que_empty(q) && sweep->seeds[next].steps > level)
+            level = sweep->seeds[next].steps;
+
+        for(; next < count && sweep->seeds[next].steps == level; ++next)
+            if(!bit_test(sweep->seen, sweep->seeds[next].cell - first))
+            {
+                reachCell(sweep, sweep->seeds[next].cell, level, first, end);
+                que_insert(q, sweep->seeds[next].cell);
+            }
+
+        stat_level(que_size(q));
+        for(size_t levelSize = que_size(q); levelSize > 0; --levelSize)
+        {
+            uint32_t searching = que_remove(q);
+
+            uint32_t neighbors[4] = {
+                maze_east(maze, searching),
+                maze_south(maze, searching),
+                maze_west(maze, searching),
+                maze_north(maze, searching)
+            };
+
+            // the border walls keep the search in the maze, and the band's
+            // own edges keep it in the band
+            for(int i = 0; i < 4; ++i)
+                if(neighbors[i] >= first && neighbors[i] < end &&
+                   !bit_test(sweep->seen, neighbors[i] - first))
+                {
+                    reachCell(sweep, neighbors[i], level + 1, first, end);
+                    que_insert(q, neighbors[i]);
+                }
+        }
+    }
+
+    // keeps the first and last rows, and marks the bands beside them if a
+    // step across (into an open cell) would get somewhere sooner than they
+    // already do (if not, nothing past that cell can get any closer either)
+    uint32_t *edges = sweep->edges + band * 2 * cols;
+    const uint32_t *up = (band > 0) ? edges - cols : NULL,
+                   *down = (band + 1 < sweep->bands) ? edges + 2 * cols : NULL;
+    for(size_t c = 0; c < cols; ++c)
+    {
+        uint32_t above = sweep->firstRow[c], below = sweep->lastRow[c];
+        if(up != NULL && above != UNREACHED && above + 1 < up[c] &&
+           !maze_isWall(maze, top - 1, c))
+            sweep->dirty[band - 1] = true;
+        if(down != NULL && below != UNREACHED && below + 1 < down[c] &&
+           !maze_isWall(maze, bottom, c))
+            sweep->dirty[band + 1] = true;
+        edges[c] = above;
+        edges[cols + c] = below;
+    }
+
+    return sweep->goalSteps;
+}
+
+
+/// searches band after band, down and then up, until none changes
+size_t solve_sweep( Maze maze, uint32_t start, uint32_t goal,
+                    size_t bandRows )
+{
+    // waste of time if we can't get in/out of the maze
+    if(bit_test(maze->walls, goal) || bit_test(maze->walls, start))
+        return 0;
+
+    // if we start on the goal, we're already done
+    if(start == goal)
+        return 1;
+
+    // by default, the bands that hold the least at once (the band being
+    // searched and the rows every band keeps weigh the same)
+    if(bandRows == 0)
+        bandRows = (size_t) (8.0 * sqrt((double) maze->rows));
+    if(bandRows < 1)
+        bandRows = 1;
+    if(bandRows > maze->rows)
+        bandRows = maze->rows;
+
+    struct sweep_s sweep = { 0 };
+    sweep.maze = maze;
+    sweep.bandRows = bandRows;
+    sweep.bands = (maze->rows + bandRows - 1) / bandRows;
+    sweep.start = start;
+    sweep.goal = goal;
+    sweep.edges = malloc(sweep.bands * 2 * maze->cols * sizeof(uint32_t));
+    sweep.dirty = calloc(sweep.bands, sizeof(bool));
+    sweep.seen = malloc(bandRows * maze->stride / 8);
+    sweep.firstRow = malloc(maze->cols * sizeof(uint32_t));
+    sweep.lastRow = malloc(maze->cols * sizeof(uint32_t));
+    sweep.seeds = malloc((2 * maze->cols + 1) * sizeof(struct seed_s));
+    sweep.queue = que_create(2 * maze->cols);
+    if(sweep.edges == NULL || sweep.dirty == NULL || sweep.seen == NULL ||
+       sweep.firstRow == NULL || sweep.lastRow == NULL ||
+       sweep.seeds == NULL || sweep.queue == NULL)
+    {
+        fprintf(stderr, "Unable to allocate a sweep of %zu row bands.\n",
+                bandRows);
+        exit(EXIT_FAILURE);
+    }
+
+    // nothing has been reached yet, so only the start's band has anything to
+    // search from
+    for(size_t i = 0; i < sweep.bands * 2 * maze->cols; ++i)
+        sweep.edges[i] = UNREACHED;
+    size_t startBand = maze_row(maze, start) / bandRows,
+           goalBand = maze_row(maze, goal) / bandRows;
+    sweep.dirty[startBand] = true;
+
+    // sweeps down, then up, searching the bands that are marked
+    stat_search();
+    for(bool searched = true; searched; )
+    {
+        searched = false;
+        for(size_t band = 0; band < sweep.bands; ++band)
+            if(sweep.dirty[band])
+            {
+                sweep.dirty[band] = false;
+                searchBand(&sweep, band);
+                searched = true;
+            }
+        for(size_t band = sweep.bands; band-- > 0; )
+            if(sweep.dirty[band])
+            {
+                sweep.dirty[band] = false;
+                searchBand(&sweep, band);
+                searched = true;
+            }
+    }
+
+    // every kept row is settled, so one more search of the goal's band
+    // gives the goal's distance
+    uint32_t found = searchBand(&sweep, goalBand);
+
+    que_destroy(sweep.queue);
+    free(sweep.seeds);
+    free(sweep.seen);
+    free(sweep.firstRow);
+    free(sweep.lastRow);
+    free(sweep.dirty);
+    free(sweep.edges);
+
+    return (found == UNREACHED) ? 0 : found;
+}
@@ -0,0 +1,227 @@
+///
+/// File: tiled.c
+///
+/// Description: A copy of a maze's walls kept in 64 x 64 cell tiles, and a BFS
+///              that searches it.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#include <stdbool.h> // boolean items
+#include <stdio.h> // error reporting
+#include <stdlib.h> // allocation functions
+#include <string.h> // memcpy, memset
+#include "tiled.h" // tiled maze functions and structures
+#include "queue.h" // queue related items
+#include "stats.h" // instrumentation counters
+
+
+///
+/// Function: spreadBits
+///
+/// Description: Spreads the bits of a number out to every other bit, so two
+///              spread numbers can be interleaved with a shift and an OR.
+///
+/// @param x  The number to spread (less than 2^16).
+///
+/// @return x with bit i moved to bit 2i.
+///
+static uint32_t spreadBits(uint32_t x)
+{
+    x = (x | (x << 8)) & 0x00ff00ff;
+    x = (x | (x << 4)) & 0x0f0f0f0f;
+    x = (x | (x << 2)) & 0x33333333;
+    x = (x | (x << 1)) & 0x55555555;
+    return x;
+}
+
+
+///
+/// Function: tileIndex
+///
+/// Description: Works out where in the plane a tile is kept.
+///
+/// @param tiled  The maze the tile is in.
+/// @param tileRow  The row of tiles the tile is in.
+/// @param tileCol  The column of tiles the tile is in.
+///
+/// @return the index of the tile (its first word is 64 times that).
+///
+static uint32_t tileIndex(TiledMaze tiled, size_t tileRow, size_t tileCol)
+{
+    if(tiled->order == TILE_ROWS)
+        return (uint32_t) (tileRow * tiled->tileCols + tileCol);
+
+    // the blocks run down a tall maze and across a wide one
+    size_t side = tiled->side;
+    size_t block = (tiled->tileRows >= tiled->tileCols) ? tileRow / side
+                                                        : tileCol / side;
+
+    return (uint32_t) (block * side * side) |
+           (spreadBits((uint32_t) (tileRow % side)) << 1) |
+           spreadBits((uint32_t) (tileCol % side));
+}
+
+
+/// copies the walls of a maze into tiles, a word (a row of a tile) at a time
+TiledMaze tile_create( Maze maze, TileOrder order )
+{
+    TiledMaze tiled = calloc(1, sizeof(struct tiledMaze_s));
+    if(tiled == NULL)
+        return NULL;
+
+    // the padded rows are cut into tiles, as are the padded columns (the
+    // stride is a multiple of 64, so a word of a row is a row of a tile)
+    size_t rowWords = maze->stride / 64;
+    tiled->rows = maze->rows;
+    tiled->cols = maze->cols;
+    tiled->tileRows = (maze->rows + 2 + TILE_SIDE - 1) / TILE_SIDE;
+    tiled->tileCols = rowWords;
+    tiled->order = order;
+
+    // Z-order keeps square blocks, as wide as the narrower side of the grid
+    size_t shorter = (tiled->tileRows < tiled->tileCols) ? tiled->tileRows
+                                                         : tiled->tileCols;
+    size_t longer = tiled->tileRows + tiled->tileCols - shorter;
+    tiled->side = 1;
+    if(order == TILE_MORTON)
+        while(tiled->side < shorter)
+            tiled->side <<= 1;
+    tiled->tiles = (order == TILE_MORTON)
+                   ? (longer + tiled->side - 1) / tiled->side *
+                     tiled->side * tiled->side
+                   : tiled->tileRows * tiled->tileCols;
+
+    // every bit must be addressable with a 32-bit cell index
+    if(tiled->tiles > ((size_t) UINT32_MAX + 1) / (TILE_SIDE * TILE_SIDE))
+    {
+        free(tiled);
+        return NULL;
+    }
+
+    tiled->words = tiled->tiles * TILE_SIDE;
+    tiled->walls = malloc(tiled->words * sizeof(uint64_t));
+    tiled->adjacent = malloc(tiled->tiles * 4 * sizeof(uint32_t));
+    if(tiled->walls == NULL || tiled->adjacent == NULL)
+    {
+        tile_destroy(tiled);
+        return NULL;
+    }
+
+    // the rows past the bottom border (and any tiles Z-order only keeps to
+    // square off its blocks) are walls
+    memset(tiled->walls, 0xff, tiled->words * sizeof(uint64_t));
+
+    for(size_t r = 0; r < maze->rows + 2; ++r)
+    {
+        const uint64_t *row = maze->walls + r * rowWords;
+        for(size_t w = 0; w < rowWords; ++w)
+            tiled->walls[(size_t) tileIndex(tiled, r / TILE_SIDE, w) *
+                         TILE_SIDE + r % TILE_SIDE] = row[w];
+    }
+
+    // the tiles to every side (a tile on the edge refers to itself there)
+    for(size_t tr = 0; tr < tiled->tileRows; ++tr)
+        for(size_t tc = 0; tc < tiled->tileCols; ++tc)
+        {
+            uint32_t *adjacent = tiled->adjacent +
+                                 (size_t) tileIndex(tiled, tr, tc) * 4;
+            uint32_t self = tileIndex(tiled, tr, tc);
+
+            adjacent[0] = (tc + 1 < tiled->tileCols)
+                          ? tileIndex(tiled, tr, tc + 1) : self;
+            adjacent[1] = (tr + 1 < tiled->tileRows)
+                          ? tileIndex(tiled, tr + 1, tc) : self;
+            adjacent[2] = (tc > 0) ? tileIndex(tiled, tr, tc - 1) : self;
+            adjacent[3] = (tr > 0) ? tileIndex(tiled, tr - 1, tc) : self;
+        }
+
+    return tiled;
+}
+
+
+/// frees the tiled maze and its planes
+void tile_destroy( TiledMaze tiled )
+{
+    // nothing to do for a maze that was never made
+    if(tiled == NULL)
+        return;
+
+    free(tiled->walls);
+    free(tiled->adjacent);
+    free(tiled);
+}
+
+
+/// the tile the padded cell is in, then its place in that tile
+uint32_t tile_cell( TiledMaze tiled, size_t row, size_t col )
+{
+    size_t r = row + 1, c = col + 1;
+
+    return (tileIndex(tiled, r / TILE_SIDE, c / TILE_SIDE) << 12) |
+           (uint32_t) ((r % TILE_SIDE) << 6) | (uint32_t) (c % TILE_SIDE);
+}
+
+
+/// a level-synchronous BFS, as solve_bfs runs it top-down, over the tiles
+size_t tile_solve( TiledMaze tiled, uint32_t start, uint32_t goal )
+{
+    // waste of time if we can't get in/out of the maze
+    if(bit_test(tiled->walls, goal) || bit_test(tiled->walls, start))
+        return 0;
+
+    // if we start on the goal, we're already done
+    if(start == goal)
+        return 1;
+
+    // the visitation map starts as a copy of the walls
+    uint64_t *visited = malloc(tiled->words * sizeof(uint64_t));
+    Queue q = que_create(2 * (tiled->rows + tiled->cols));
+    if(visited == NULL || q == NULL)
+    {
+        fprintf(stderr, "Unable to allocate a search of %zu words.\n",
+                tiled->words);
+        exit(EXIT_FAILURE);
+    }
+    memcpy(visited, tiled->walls, tiled->words * sizeof(uint64_t));
+
+    que_insert(q, start);
+    bit_set(visited, start);
+
+    // the number of steps (0 until the goal is found)
+    size_t steps = 0;
+
+    stat_search();
+    for(size_t levelSteps = 1; steps == 0 && !que_empty(q); ++levelSteps)
+    {
+        stat_level(que_size(q));
+        for(size_t levelSize = que_size(q); levelSize > 0; --levelSize)
+        {
+            uint32_t searching = que_remove(q);
+
+            uint32_t neighbors[4] = {
+                tile_east(tiled, searching),
+                tile_south(tiled, searching),
+                tile_west(tiled, searching),
+                tile_north(tiled, searching)
+            };
+
+            for(int i = 0; i < 4; ++i)
+                if(!bit_test(visited, neighbors[i]))
+                {
+                    que_insert(q, neighbors[i]);
+                    bit_set(visited, neighbors[i]);
+                }
+        }
+
+        // the goal was reached in this level
+        if(bit_test(visited, goal))
+            steps = levelSteps + 1;
+    }
+
+    que_destroy(q);
+    free(visited);
+
+    return steps;
+}
@@ -0,0 +1,147 @@
+///
+/// File: tiled.h
+///
+/// Description: Interface to the TiledMaze module, a copy of a Maze's walls
+///              laid out in 64 x 64 cell tiles instead of whole rows.
+///
+///              In the row layout the cell below another is a full padded row
+///              away, so a search moving down a wide maze touches a new cache
+///              line (and, past 32768 columns, a new page) every step. A tile
+///              is 64 words, one per row of the tile, so within it the cells
+///              to every side are in the same 512 bytes. The tiles themselves
+///              are kept either a row of tiles after another or in Z-order
+///              (Morton order), which also keeps the tiles that are close in
+///              the maze close in memory.
+///
+/// @author kjb2503 : Kevin Becker
+///
+// // // // // // // // // // // // // // // // // // // // // // // // // // //
+
+#ifndef _TILED_H_
+#define _TILED_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "maze.h"
+
+// the side of a tile, in cells (one word is one row of a tile)
+#define TILE_SIDE 64
+
+// the orders the tiles can be kept in
+typedef enum tileOrder_e{
+    // a row of tiles after another
+    TILE_ROWS,
+    // Z-order (Morton order); a very tall or very wide maze is kept as a
+    // column (or row) of square Z-ordered blocks of tiles
+    TILE_MORTON
+} TileOrder;
+
+// TiledMaze structure
+// NOTE: the padded grid (border and padding included, just as in a Maze) is
+//       cut into tiles and cell (r, c) lives at bit
+//       tile * 4096 + ((r + 1) % 64) * 64 + (c + 1) % 64 of the plane, where
+//       tile is the tile (r + 1) / 64, (c + 1) / 64 is kept at. Cells are
+//       referred to by that packed 32-bit bit index. The tiles to every side
+//       of each tile are kept so a step out of a tile is a lookup.
+typedef struct tiledMaze_s{
+    // the number of rows and columns in the maze (border not included)
+    size_t rows, cols;
+    // the number of rows and columns of tiles
+    size_t tileRows, tileCols;
+    // the order the tiles are kept in
+    TileOrder order;
+    // the side of a Z-ordered block of tiles (a power of two)
+    size_t side;
+    // the number of tiles kept (Z-order may keep some that are all padding)
+    size_t tiles;
+    // the number of 64-bit words in one plane (64 to a tile)
+    size_t words;
+    // the wall plane itself
+    uint64_t *walls;
+    // the tiles to the EAST, SOUTH, WEST and NORTH of each tile, 4 to a tile
+    // (a tile on the edge of the grid refers to itself on that side; the
+    // border keeps a search from ever stepping that way)
+    uint32_t *adjacent;
+} * TiledMaze;
+
+///
+/// Create a TiledMaze from the walls of a Maze.
+///
+/// @param maze  the maze to copy (it may be destroyed afterward).
+/// @param order  the order to keep the tiles in.
+///
+/// @return a TiledMaze instance, or NULL if the tiled plane is too large to
+///         index with 32 bits or the allocation fails.
+///
+TiledMaze tile_create( Maze maze, TileOrder order );
+
+///
+/// Tear down and deallocate the supplied TiledMaze.
+///
+/// @param tiled - the TiledMaze to be deallocated.
+///
+void tile_destroy( TiledMaze tiled );
+
+///
+/// Gets the packed index of a cell.
+///
+/// @param tiled  the maze the cell is in.
+/// @param row  the row of the cell.
+/// @param col  the column of the cell.
+///
+/// @return the packed index of (row, col).
+///
+uint32_t tile_cell( TiledMaze tiled, size_t row, size_t col );
+
+///
+/// Gets the packed index of the neighbor to the EAST/SOUTH/WEST/NORTH of a
+/// cell. Thanks to the sentinel border the neighbor always exists; the
+/// neighbor is in the same tile unless the cell is on that edge of it.
+///
+static inline uint32_t tile_east( const struct tiledMaze_s *tiled,
+                                  uint32_t cell )
+{
+    if((cell & 63) != 63)
+        return cell + 1;
+    return (tiled->adjacent[(cell >> 12) * 4] << 12) | (cell & 0xfc0);
+}
+
+static inline uint32_t tile_south( const struct tiledMaze_s *tiled,
+                                   uint32_t cell )
+{
+    if((cell & 0xfc0) != 0xfc0)
+        return cell + 64;
+    return (tiled->adjacent[(cell >> 12) * 4 + 1] << 12) | (cell & 63);
+}
+
+static inline uint32_t tile_west( const struct tiledMaze_s *tiled,
+                                  uint32_t cell )
+{
+    if((cell & 63) != 0)
+        return cell - 1;
+    return (tiled->adjacent[(cell >> 12) * 4 + 2] << 12) | (cell & 0xfc0) | 63;
+}
+
+static inline uint32_t tile_north( const struct tiledMaze_s *tiled,
+                                   uint32_t cell )
+{
+    if((cell & 0xfc0) != 0)
+        return cell - 64;
+    return (tiled->adjacent[(cell >> 12) * 4 + 3] << 12) | (cell & 63) | 0xfc0;
+}
+
+///
+/// Uses BFS to determine the shortest number of steps from one cell to another
+/// in a tiled maze. It searches just as solve_bfs does top-down, with a
+/// visitation map laid out in tiles like the walls.
+///
+/// @param tiled  the maze to search.
+/// @param start  the packed index of the cell to start from.
+/// @param goal  the packed index of the cell to get to.
+///
+/// @return 0 if there is no path, otherwise the number of cells on the
+///         shortest path (the same count solve_bfs gives).
+///
+size_t tile_solve( TiledMaze tiled, uint32_t start, uint32_t goal );
+
+#endif